@@ -0,0 +1,265 @@
+/*
+    anytimesearch.hpp: Anytime repairing A* (ARA*).
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file anytimesearch.hpp
+ * @brief Graph search that finds a solution quickly with an inflated heuristic, then improves it.
+ */
+
+#ifndef ANYTIME_SEARCH_H
+#define ANYTIME_SEARCH_H
+
+#include "bestfirstsearch.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace jsearch
+{
+	/**
+	 * @brief The heuristic weights of anytime_search: INITIAL first, then STEP less each time down to 1.
+	 */
+	struct weight_schedule
+	{
+		weight_schedule(double const INITIAL = 3, double const STEP = 0.5) : initial(INITIAL), step(STEP) {}
+
+		double next(double const WEIGHT) const { return std::max(1.0, WEIGHT - step); }
+
+		double initial, step;
+	};
+
+
+	namespace detail
+	{
+		/**
+		 * @brief Order the frontier of anytime_search by the weighted f of a cost function whose weight
+		 * changes, breaking ties on higher g.
+		 */
+		template <class CostFunction>
+		class anytime_order
+		{
+		public:
+			typedef typename CostFunction::Node Node;
+
+			anytime_order(CostFunction const &COST) : cost(&COST) {}
+
+			bool operator()(Node const &A, Node const &B) const
+			{
+				auto const Af(cost->f(A)), Bf(cost->f(B));
+				return Af == Bf ? A->path_cost() < B->path_cost() : Af > Bf;
+			}
+
+		private:
+			CostFunction const *cost;
+		};
+
+
+		/**
+		 * @brief Let an Observer evaluate nodes by their unweighted f.
+		 */
+		template <class CostFunction>
+		class lower_bound_evaluator
+		{
+		public:
+			lower_bound_evaluator(CostFunction const &COST) : cost(COST) {}
+
+			template <typename Node>
+			typename CostFunction::PathCost f(Node const &N) const { return cost.lower_bound(N); }
+
+		private:
+			CostFunction const &cost;
+		};
+	}
+
+
+	/*********************************************
+	 *	Anytime repairing A* (ARA*)	 	 	 	 *
+	 *********************************************/
+	/**
+	 * @brief Anytime graph search after Likhachev, Gordon and Thrun (2003).
+	 *
+	 * The search runs weighted A* with the weights of SCHEDULE in turn.  CostFunction must have a runtime
+	 * weight and a lower_bound(Node), as WeightedAStar does, and its heuristic must be consistent.  Each
+	 * search stops as soon as no node on the frontier has a weighted f below the cost of the best solution
+	 * so far.  Instead of starting again, the next search reorders the same frontier for its weight, adds
+	 * to it the states whose g improved after they were expanded, and forgets every node whose unweighted
+	 * f cannot beat the best solution.
+	 *
+	 * Each better solution is passed to improved(COST, BOUND, PATH), where PATH is a std::vector of the
+	 * states from the goal back to the initial state, and the cost of an optimal solution is at least
+	 * COST / BOUND.  The search ends when a solution is proved optimal, i.e. after searching with weight 1,
+	 * or when nothing is left to search.
+	 *
+	 * The Observer is told about each node that is forgotten by pruned().
+	 *
+	 * @return The path cost of the best solution, whose path is written from the goal back to the initial
+	 * state.
+	 *
+	 * @throws goal_not_found
+	 */
+	template <template <typename Traits> class CostFunction,
+			template <typename T, typename Comparator> class PriorityQueue,
+			template <typename T> class Set,
+			template <typename Key, typename Value> class Map,
+			typename Traits,
+			template <typename Traits_> class StepCostPolicy,
+			template <typename Traits_> class ActionsPolicy,
+			template <typename Traits_> class ResultPolicy,
+			template <typename Traits_> class GoalTestPolicy,
+			template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy,
+				template <typename Traits__> class ResultPolicy,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy,
+			typename Output,
+			typename Callback,
+			typename Observer = null_observer>
+	typename Traits::pathcost anytime_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, weight_schedule const &SCHEDULE, Output path, Callback &&improved, Observer &&observer = Observer())
+	{
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+		typedef typename Traits::action Action;
+		typedef detail::anytime_order<CostFunction<Traits>> Order;
+
+		detail::release_guard<Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy>> const RELEASE(PROBLEM);
+		detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+		CostFunction<Traits> cost(std::max(1.0, SCHEDULE.initial));
+		detail::lower_bound_evaluator<CostFunction<Traits>> const EVALUATOR(cost);
+		jsearch::queue_set<PriorityQueue<Node, Order>, Map> frontier{Order(cost)};
+		Map<State, Node> best; // The node with the lowest g seen for each state.
+		Set<State> closed; // By the search with the current weight.
+		std::vector<Node> inconsistent, reorder;
+		std::vector<State> solution;
+		Node incumbent(nullptr);
+
+		// Whether NODE cannot lead to a better solution than the incumbent.
+		auto const HOPELESS = [&](Node const &NODE)
+		{
+			return incumbent && cost.lower_bound(NODE) >= incumbent->path_cost();
+		};
+
+		auto const INITIAL(PROBLEM.create(PROBLEM.initial, Node(), Action(), 0));
+		best[INITIAL->state()] = INITIAL;
+		frontier.push(INITIAL);
+
+		for(;;)
+		{
+			Node const PREVIOUS(incumbent);
+
+			while(!frontier.empty() && !(incumbent && cost.f(frontier.top()) >= incumbent->path_cost()))
+			{
+				auto const S(detail::pop(frontier));
+				observer.popped();
+				if(HOPELESS(S))
+				{
+					observer.pruned();
+					continue;
+				}
+
+				if(observer.measure(phase::goal_test, [&]{ return PROBLEM.goal_test(S->state()); }))
+				{
+					incumbent = S;
+					break;
+				}
+
+				closed.insert(S->state());
+				observer.expanded(S, EVALUATOR);
+				detail::for_each_action(PROBLEM, S->state(), [&](Action const &ACTION)
+				{
+					auto const SUCCESSOR(observer.measure(phase::child, [&]{ return PROBLEM.result(S->state(), ACTION); }));
+					auto const CHILD(observer.measure(phase::child, [&]{ return PROBLEM.child(S, ACTION, SUCCESSOR); }));
+					auto const KNOWN(best.find(SUCCESSOR));
+
+					if(KNOWN != std::end(best) && KNOWN->second->path_cost() <= CHILD->path_cost())
+						observer.discarded();
+					else if(HOPELESS(CHILD))
+						observer.pruned();
+					else
+					{
+						best[SUCCESSOR] = CHILD;
+						auto const OPEN(frontier.find(SUCCESSOR));
+						if(OPEN != std::end(frontier))
+						{
+							frontier.increase(OPEN->second, CHILD); // The DECREASE-KEY operation is an increase because it is a max-heap.
+							observer.decreased();
+						}
+						else if(closed.find(SUCCESSOR) != std::end(closed))
+							inconsistent.push_back(CHILD); // Improved too late for this weight.
+						else
+						{
+							frontier.push(CHILD);
+							observer.pushed();
+						}
+					}
+				}, observer);
+				observer.sizes(frontier.size(), closed.size());
+			}
+
+			// Everything that is left, inconsistent or on the frontier, for the next weight.
+			reorder.clear();
+			for(auto const &OPEN : frontier)
+				reorder.push_back(*OPEN.second);
+			for(auto const &NODE : inconsistent)
+				if(best.find(NODE->state())->second == NODE)
+					reorder.push_back(NODE);
+
+			if(!incumbent)
+			{
+				if(reorder.empty())
+					throw goal_not_found();
+			}
+			else
+			{
+				auto lowest(incumbent->path_cost());
+				for(auto const &NODE : reorder)
+					lowest = std::min(lowest, cost.lower_bound(NODE));
+
+				double const BOUND(lowest > 0 ? std::min(cost.weight(), double(incumbent->path_cost()) / lowest) : cost.weight());
+				if(incumbent != PREVIOUS)
+				{
+					solution.clear();
+					detail::unravel(std::back_inserter(solution), incumbent);
+					improved(incumbent->path_cost(), std::max(1.0, BOUND), solution);
+				}
+
+				if(cost.weight() == 1 || BOUND <= 1 || reorder.empty())
+					break;
+			}
+
+			cost.weight(SCHEDULE.next(cost.weight()));
+			frontier.clear();
+			for(auto const &NODE : reorder)
+			{
+				if(HOPELESS(NODE))
+					observer.pruned();
+				else
+					frontier.push(NODE);
+			}
+			inconsistent.clear();
+			closed.clear();
+		}
+
+		detail::unravel(path, incumbent);
+		return incumbent->path_cost();
+	}
+}
+
+#endif // ANYTIME_SEARCH_H
@@ -0,0 +1,243 @@
+/*
+    beamsearch.hpp: Beam search, which keeps only the best nodes of each layer.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file beamsearch.hpp
+ * @brief Search of bounded width for when an approximate answer on time is worth more than the best one late.
+ */
+
+#ifndef BEAM_SEARCH_H
+#define BEAM_SEARCH_H
+
+#include "bestfirstsearch.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace jsearch
+{
+	namespace detail
+	{
+		/**
+		 * @brief What the graph form of beam_search knows about a state: the least g it was reached by, and
+		 * where that node is among the candidates of its layer.
+		 */
+		template <typename PathCost>
+		struct beam_entry
+		{
+			beam_entry() : g(), layer(), slot() {}
+
+			PathCost g;
+			std::size_t layer, slot;
+		};
+
+
+		/**
+		 * @brief Expand the beam layer by layer, keeping the best WIDTH of the children of each layer as the next.
+		 *
+		 * PLACE(CHILD, LAYER, candidates) decides whether CHILD, of the layer numbered LAYER, becomes one of the
+		 * candidates for that layer.  The candidates are then ranked by COMPARE, and the rest are forgotten.
+		 * Within a layer, the nodes are goal tested and expanded in order of rank, so the goal that is returned
+		 * is the best of the first layer that has one.  CLOSED() is the number of states in the Table, if there is
+		 * one, for the Observer.
+		 */
+		template <class Problem, class Comparator, typename Place, typename Closed, class Observer>
+		typename Problem::Node beam_layers(Problem const &PROBLEM, std::size_t const WIDTH, Comparator const &COMPARE, Place &&place, Closed &&closed, Observer &observer)
+		{
+			typedef typename Problem::Node Node;
+			typedef typename Problem::State State;
+			typedef typename Problem::Action Action;
+
+			// COMPARE(A, B) means that B comes first, as for the frontier of best_first_search.
+			auto const BETTER = [&](Node const &A, Node const &B){ return COMPARE(B, A); };
+			std::vector<Node> beam, candidates, children; // children is only used if the Problem evaluates in batches.
+			beam.reserve(WIDTH);
+
+			auto const INITIAL(PROBLEM.create(PROBLEM.initial, Node(), Action(), 0));
+			refine(PROBLEM, INITIAL, observer);
+			beam.push_back(INITIAL);
+
+			for(std::size_t layer(1); !beam.empty(); ++layer)
+			{
+				candidates.clear();
+				for(auto const &S : beam)
+				{
+					observer.popped();
+					if(observer.measure(phase::goal_test, [&]{ return PROBLEM.goal_test(S->state()); }))
+						return S;
+
+					observer.expanded(S, COMPARE);
+					if(evaluates_in_batches<Problem>::value)
+					{
+						for_each_child_batch(PROBLEM, S, children, [](State const &){ return true; }, [&](Node const &CHILD)
+						{
+							place(CHILD, layer, candidates);
+						}, observer);
+					}
+					else
+					{
+						for_each_action(PROBLEM, S->state(), [&](Action const &ACTION)
+						{
+							auto const SUCCESSOR(observer.measure(phase::child, [&]{ return PROBLEM.result(S->state(), ACTION); }));
+							auto const CHILD(observer.measure(phase::child, [&]{ return PROBLEM.child(S, ACTION, SUCCESSOR); }));
+							refine(PROBLEM, CHILD, observer); // A lazy child is ranked by its f, not by its bound.
+							place(CHILD, layer, candidates);
+						}, observer);
+					}
+				}
+
+				if(candidates.size() > WIDTH)
+				{
+					std::nth_element(std::begin(candidates), std::begin(candidates) + WIDTH, std::end(candidates), BETTER);
+					for(std::size_t i(WIDTH); i != candidates.size(); ++i)
+						observer.pruned();
+					candidates.erase(std::begin(candidates) + WIDTH, std::end(candidates));
+				}
+				std::sort(std::begin(candidates), std::end(candidates), BETTER);
+				beam.swap(candidates);
+				observer.sizes(beam.size(), closed());
+			}
+
+			throw goal_not_found();
+		}
+	}
+
+
+	/**************************
+	 *	Beam search (tree)	  *
+	 **************************/
+	/**
+	 * @brief Tree search that expands a layer at a time and keeps only the best WIDTH children of each layer,
+	 * as ranked by Comparator, for the next.
+	 *
+	 * Each layer costs O(WIDTH·b) time and memory for a branching factor of b, no matter how deep the search
+	 * goes, and the beam and its candidates are kept in buffers that are only allocated for the first layers.
+	 * The answer is not optimal, and there may be none even if there is a goal, since it may be beyond a node
+	 * that was dropped.  Like tree search with best_first_search, it only ends without a goal when every path
+	 * does.  A WIDTH of 0 is taken to be 1.
+	 *
+	 * The Observer is told about each node that is dropped from the beam as pruned.
+	 *
+	 * \return A goal Node from which the path can be reconstructed.
+	 *
+	 * @throws goal_not_found
+	 */
+	template <template <typename Traits> class Comparator,
+			typename Traits,
+			template <typename Traits_> class StepCostPolicy,
+			template <typename Traits_> class ActionsPolicy,
+			template <typename Traits_> class ResultPolicy,
+			template <typename Traits_> class GoalTestPolicy,
+			template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy,
+				template <typename Traits__> class ResultPolicy,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy,
+			typename Observer = null_observer>
+	typename Traits::node beam_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, std::size_t const WIDTH, Observer &&observer = Observer())
+	{
+		typedef typename Traits::node Node;
+
+		detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+		Comparator<Traits> const COMPARE;
+
+		return detail::beam_layers(PROBLEM, std::max(WIDTH, std::size_t(1)), COMPARE, [&](Node const &CHILD, std::size_t, std::vector<Node> &candidates)
+		{
+			candidates.push_back(CHILD);
+			observer.pushed();
+		}, []{ return std::size_t(0); }, observer);
+	}
+
+
+	/**************************
+	 *	Beam search (graph)	  *
+	 **************************/
+	/**
+	 * @brief Beam search as above, but with a Table of the least g by which each state has been reached, so
+	 * that no state is a candidate twice unless by a cheaper path.
+	 *
+	 * A cheaper duplicate in the same layer takes the place of the first, and one of a later layer is a new
+	 * candidate.  The Table grows by at most WIDTH·b states per layer, and the search ends when a layer has no
+	 * new states.  Table must be like state_table.
+	 *
+	 * @return The path cost of the goal, whose path is written from the goal back to the initial state.
+	 *
+	 * @throws goal_not_found
+	 */
+	template <template <typename Traits> class Comparator,
+			template <typename Key, typename Value> class Table,
+			typename Traits,
+			template <typename Traits_> class StepCostPolicy,
+			template <typename Traits_> class ActionsPolicy,
+			template <typename Traits_> class ResultPolicy,
+			template <typename Traits_> class GoalTestPolicy,
+			template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy,
+				template <typename Traits__> class ResultPolicy,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy,
+			typename Output,
+			typename Observer = null_observer>
+	typename Traits::pathcost beam_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, std::size_t const WIDTH, Output path, Observer &&observer = Observer())
+	{
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+		typedef detail::beam_entry<typename Traits::pathcost> Known;
+
+		detail::release_guard<Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy>> const RELEASE(PROBLEM);
+		detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+		Comparator<Traits> const COMPARE;
+		Table<State, Known> table;
+
+		table.insert(PROBLEM.initial);
+
+		auto const GOAL(detail::beam_layers(PROBLEM, std::max(WIDTH, std::size_t(1)), COMPARE, [&](Node const &CHILD, std::size_t const LAYER, std::vector<Node> &candidates)
+		{
+			auto const INSERTED(table.insert(CHILD->state()));
+			Known &known(*INSERTED.first);
+			if(!INSERTED.second && !(CHILD->path_cost() < known.g))
+			{
+				observer.discarded();
+				return;
+			}
+
+			known.g = CHILD->path_cost();
+			if(!INSERTED.second && known.layer == LAYER)
+			{
+				candidates[known.slot] = CHILD;
+				observer.decreased();
+			}
+			else
+			{
+				known.layer = LAYER;
+				known.slot = candidates.size();
+				candidates.push_back(CHILD);
+				observer.pushed();
+			}
+		}, [&]{ return table.size(); }, observer));
+
+		detail::unravel(path, GOAL);
+		return GOAL->path_cost();
+	}
+}
+
+#endif // BEAM_SEARCH_H
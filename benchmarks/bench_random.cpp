@@ -0,0 +1,457 @@
+/*
+    bench_random.cpp: Benchmark the search functions on random graphs.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "random.hpp"
+#include "bestfirstsearch.hpp"
+#include "budget.hpp"
+#include "externalsearch.hpp"
+#include "incrementalsearch.hpp"
+#include "iterativedeepeningsearch.hpp"
+#include "memoryboundedsearch.hpp"
+#include "parallelsearch.hpp"
+#include "partialexpansionsearch.hpp"
+#include "searchcontext.hpp"
+#include "gg.hpp"
+#include "csr_file.hpp"
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <boost/heap/d_ary_heap.hpp>
+
+#include <unistd.h>
+
+using namespace jsearch;
+
+typedef Random::pathcost PathCost;
+typedef Problem<Random, Distance, Neighbours, Visit, GoalTest> RandomProblem;
+typedef Problem<Random, Distance, NeighboursByWeight, Visit, GoalTest> SelectingProblem;
+typedef BidirectionalProblem<Random, Distance, Neighbours, Visit, GoalTest, Edges> ReplanningProblem;
+
+
+Random::state target;
+
+// The goal is target.  GoalTest counts the states it tests, so it cannot be shared between threads.
+template <typename Traits>
+class TargetGoal
+{
+public:
+	typedef typename Traits::state State;
+
+protected:
+	bool goal_test(State const &STATE) const
+	{
+		return STATE == target;
+	}
+};
+
+typedef Problem<Random, Distance, Neighbours, Visit, TargetGoal> TargetProblem;
+
+
+template <typename Traits>
+using CostFunction = Dijkstra<Traits>;
+
+template <typename T, typename Comparator>
+using PriorityQueue = boost::heap::d_ary_heap<T, boost::heap::mutable_<true>, boost::heap::arity<2>, boost::heap::compare<Comparator>>;
+
+template <typename T>
+using RBFSPriorityQueue = boost::heap::d_ary_heap<T, boost::heap::mutable_<true>, boost::heap::arity<2>>;
+
+template <typename Traits>
+using Comparator = SimpleComparator<Traits, CostFunction>;
+
+template <typename T>
+using ClosedList = std::unordered_set<T>;
+
+template <typename Key, typename Value>
+using Map = std::unordered_map<Key, Value>;
+
+template <typename Key, typename Value>
+using Table = state_table<Key, Value>;
+
+// ZeroHeuristic and FalseTiePolicy that do not say that they are trivial, so that AStar and TiebreakingComparator
+// take their generic paths, to measure what detecting them saves.
+template <typename Traits>
+class OpaqueZeroHeuristic : public ZeroHeuristic<Traits>
+{
+public:
+	static constexpr bool trivial = false;
+};
+
+template <typename Traits>
+class OpaqueFalseTiePolicy : public FalseTiePolicy<Traits>
+{
+public:
+	static constexpr bool trivial = false;
+};
+
+template <typename Traits>
+using GenericCostFunction = AStar<Traits, OpaqueZeroHeuristic>;
+
+template <typename Traits>
+using GenericComparator = TiebreakingComparator<Traits, GenericCostFunction, OpaqueFalseTiePolicy>;
+
+template <typename Traits>
+using TrivialCostFunction = AStar<Traits, ZeroHeuristic>;
+
+template <typename Traits>
+using TrivialComparator = TiebreakingComparator<Traits, TrivialCostFunction, FalseTiePolicy>;
+
+
+// Map an instance from its file in /tmp where it is, after generating the file if there is none yet.
+Graph instance(std::size_t const SIZE, unsigned const BRANCHING, unsigned const SEED)
+{
+	std::string const PATH("/tmp/jsearch-random-" + std::to_string(SIZE) + "-" + std::to_string(BRANCHING) + "-" + std::to_string(SEED) + ".csr");
+	try
+	{
+		return map_csr_graph<Graph::weight_type, Graph::vertex_type>(PATH);
+	}
+	catch(std::exception const &)
+	{
+	}
+
+	auto const START(std::chrono::steady_clock::now());
+	gg::generate_csr_file<Graph::weight_type, Graph::vertex_type>(PATH, SIZE, BRANCHING, SEED);
+	std::cerr << "generated " << PATH << " in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - START).count() << " s\n";
+	return map_csr_graph<Graph::weight_type, Graph::vertex_type>(PATH);
+}
+
+
+// Create an empty file in /tmp that no other run has, and return its name.
+std::string temporary_file()
+{
+	char name[] = "/tmp/jsearch-snapshot-XXXXXX";
+	int const FD(mkstemp(name));
+	if(FD == -1)
+		throw std::system_error(errno, std::generic_category(), "mkstemp");
+	close(FD);
+	return name;
+}
+
+
+int main()
+{
+	unsigned const SEED(1);
+
+	bench::header();
+
+	for(unsigned const SIZE : {1000u, 100000u, 1000000u})
+	{
+		for(unsigned const BRANCHING : {4u, 8u, 16u})
+		{
+			G = instance(SIZE, BRANCHING, SEED);
+			// The goal is the state tested after expanding half of the graph, or at most 100000 states.
+			expanded = std::min(SIZE / 2, 100000u);
+			unsigned const REPETITIONS(SIZE > 1000 ? 1 : 10);
+
+			bench::run<PathCost>("random", "graph", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				RandomProblem const PROBLEM(0);
+				std::vector<Random::state> path;
+				return best_first_search<PriorityQueue, Comparator, ClosedList, Map>(PROBLEM, std::back_inserter(path), stats);
+			});
+
+			bench::run<PathCost>("random", "table", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				RandomProblem const PROBLEM(0);
+				std::vector<Random::state> path;
+				return best_first_search<PriorityQueue, Comparator, Table>(PROBLEM, std::back_inserter(path), stats);
+			});
+
+			// A* with no heuristic and no tie-breaking, through the generic comparison and the collapsed one.
+			bench::run<PathCost>("random", "table-generic", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				RandomProblem const PROBLEM(0);
+				std::vector<Random::state> path;
+				return best_first_search<PriorityQueue, GenericComparator, Table>(PROBLEM, std::back_inserter(path), stats);
+			});
+
+			bench::run<PathCost>("random", "table-trivial", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				RandomProblem const PROBLEM(0);
+				std::vector<Random::state> path;
+				return best_first_search<PriorityQueue, TrivialComparator, Table>(PROBLEM, std::back_inserter(path), stats);
+			});
+
+			bench::run<PathCost>("random", "partial", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				RandomProblem const PROBLEM(0);
+				std::vector<Random::state> path;
+				return partial_expansion_search<CostFunction, PriorityQueue, Table>(PROBLEM, std::back_inserter(path), stats);
+			});
+
+			bench::run<PathCost>("random", "partial-osf", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				SelectingProblem const PROBLEM(0);
+				std::vector<Random::state> path;
+				return partial_expansion_search<CostFunction, PriorityQueue, Table>(PROBLEM, std::back_inserter(path), stats);
+			});
+
+			bench::run<PathCost>("random", "external", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				RandomProblem const PROBLEM(0);
+				std::vector<Random::state> path;
+				return external_search<CostFunction>(PROBLEM, external_options(), std::back_inserter(path), stats);
+			});
+
+			bench::run<PathCost>("random", "tree", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				RandomProblem const PROBLEM(0);
+				return best_first_search<PriorityQueue, Comparator>(PROBLEM, stats)->path_cost();
+			});
+
+			bench::run<PathCost>("random", "rbfs", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				RandomProblem const PROBLEM(0);
+				return recursive_best_first_search<CostFunction, FalseTiePolicy, RBFSPriorityQueue>(PROBLEM, stats)->path_cost();
+			});
+
+			bench::run<PathCost>("random", "ida", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				RandomProblem const PROBLEM(0);
+				std::vector<Random::state> path;
+				return iterative_deepening_search<CostFunction>(PROBLEM, std::back_inserter(path), stats);
+			});
+
+			bench::run<PathCost>("random", "sma", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				RandomProblem const PROBLEM(0);
+				return memory_bounded_search<CostFunction, FalseTiePolicy>(PROBLEM, 10000, stats)->path_cost();
+			});
+
+			if(SIZE > 100000)
+				continue;
+
+			/*	To the goal of the searches above, as a fixed state, sequentially and on 1 and 2 threads, however
+			 *	many CPUs there are.  With fewer CPUs than threads, each thread of HDA* searches its share of the
+			 *	graph alone for a time slice, by paths that the others have since beaten, and so re-expands much
+			 *	of the graph, where the threads of the multiqueue share one frontier and do not.  Each thread of
+			 *	a parallel search counts into its own statistics, which are merged into the row's, but the time
+			 *	is that of the whole search.	*/
+			{
+				RandomProblem const PROBLEM(0);
+				std::vector<Random::state> path;
+				best_first_search<PriorityQueue, Comparator, Table>(PROBLEM, std::back_inserter(path));
+				target = path.front();
+			}
+			bench::run<PathCost>("random", "table-target", SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				TargetProblem const PROBLEM(0);
+				std::vector<Random::state> path;
+				return best_first_search<PriorityQueue, Comparator, Table>(PROBLEM, std::back_inserter(path), stats);
+			});
+
+			for(unsigned const THREADS : {1u, 2u})
+			{
+				bench::run<PathCost>("random", "hda-" + std::to_string(THREADS), SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+				{
+					TargetProblem const PROBLEM(0);
+					std::vector<Random::state> path;
+					std::vector<statistics<PathCost>> threads(THREADS);
+					stats.started();
+					auto const COST(parallel_best_first_search<PriorityQueue, Comparator, Map>(PROBLEM, std::back_inserter(path), threads));
+					stats.finished();
+					for(auto const &THREAD : threads)
+						stats.merge(THREAD);
+					return COST;
+				});
+
+				bench::run<PathCost>("random", "multiqueue-" + std::to_string(THREADS), SIZE, BRANCHING, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+				{
+					TargetProblem const PROBLEM(0);
+					std::vector<Random::state> path;
+					std::vector<statistics<PathCost>> threads(THREADS);
+					stats.started();
+					auto const COST(shared_frontier_search<Comparator>(PROBLEM, std::back_inserter(path), threads));
+					stats.finished();
+					for(auto const &THREAD : threads)
+						stats.merge(THREAD);
+					return COST;
+				});
+			}
+
+			// A batch of queries between random states, answered one at a time by one context, and then
+			// as the distances from one source.  The cost is the sum over the batch.
+			unsigned const QUERIES(100);
+			std::vector<Random::state> sources, goals;
+			std::mt19937 queries(SEED);
+			std::uniform_int_distribution<Random::state> state(0, SIZE - 1);
+			for(unsigned i(0); i != QUERIES; ++i)
+			{
+				sources.push_back(state(queries));
+				goals.push_back(state(queries));
+			}
+
+			RandomProblem const PROBLEM(0);
+			search_context<RandomProblem, PriorityQueue, Comparator, Table> context(PROBLEM);
+
+			PathCost fresh(0);
+			bench::run<PathCost>("random", "context", SIZE, BRANCHING, SEED, 1, [&](statistics<PathCost> &stats)
+			{
+				PathCost total(0);
+				std::vector<Random::state> path;
+				for(unsigned i(0); i != QUERIES; ++i)
+				{
+					path.clear();
+					total += context.search(sources[i], goals[i], std::back_inserter(path), stats);
+				}
+				return fresh = total;
+			});
+
+			// The same batch, with each query stopped after a few expansions, saved to a snapshot, restored
+			// and resumed, which must come to the same total.
+			std::string const SNAPSHOT(temporary_file());
+			budget const LIMITS(budget().max_expansions(QUERIES));
+			bench::run<PathCost>("random", "context-snapshot", SIZE, BRANCHING, SEED, 1, [&](statistics<PathCost> &stats)
+			{
+				PathCost total(0);
+				std::vector<Random::state> path;
+				for(unsigned i(0); i != QUERIES; ++i)
+				{
+					path.clear();
+					try
+					{
+						total += context.search(sources[i], goals[i], std::back_inserter(path), budgeted<Random, statistics<PathCost> &>(LIMITS, stats));
+					}
+					catch(budget_exhausted<Random> const &)
+					{
+						{
+							std::ofstream file(SNAPSHOT, std::ios::binary);
+							context.save(file);
+						}
+						context.restore(SNAPSHOT);
+						path.clear();
+						total += context.resume(std::back_inserter(path), stats);
+					}
+				}
+				std::remove(SNAPSHOT.c_str());
+				if(total != fresh)
+					std::cerr << "context-snapshot: " << total << " is not " << fresh << "\n";
+				return total;
+			});
+
+			bench::run<PathCost>("random", "distances", SIZE, BRANCHING, SEED, 1, [&](statistics<PathCost> &stats)
+			{
+				std::vector<PathCost> costs;
+				context.distances(sources.front(), std::begin(goals), std::end(goals), std::back_inserter(costs), stats);
+				PathCost total(0);
+				for(auto const COST : costs)
+					total += COST;
+				return total;
+			});
+
+			// Replan from 0 to the far side of the graph after each of a series of changes to the weight of
+			// one edge, in both directions, incrementally and then from scratch.  Only the replans are timed,
+			// and the cost is the sum over the series.  The edges are spread along the first path and each is
+			// made dearer, so that every change is in the region that was searched and has to be repaired.
+			unsigned const CHANGES(20);
+			std::vector<std::pair<Graph::edge_type, Graph::edge_type>> changed;
+			std::vector<PathCost> weights;
+			std::mt19937 changes(SEED);
+			std::uniform_real_distribution<PathCost> raise(1, 500);
+			std::vector<Random::state> route; // From the goal back to 0.
+			context.search(0, SIZE / 2, std::back_inserter(route));
+			for(unsigned i(0); i != CHANGES; ++i)
+			{
+				auto const J(i * (route.size() - 1) / CHANGES);
+				auto const U(route[J + 1]), V(route[J]);
+				Graph::edge_type EDGE(0);
+				bool found(false);
+				for(auto const CANDIDATE : G.out_edges(U))
+				{
+					if(G.target(CANDIDATE) == V && (!found || G.weight(CANDIDATE) < G.weight(EDGE)))
+					{
+						EDGE = CANDIDATE;
+						found = true;
+					}
+				}
+				for(auto const REVERSE : G.out_edges(V))
+				{
+					if(G.target(REVERSE) == U && G.weight(REVERSE) == G.weight(EDGE))
+					{
+						changed.emplace_back(EDGE, REVERSE);
+						break;
+					}
+				}
+				weights.push_back(G.weight(EDGE) + raise(changes));
+			}
+
+			ReplanningProblem const REPLANNING(0, SIZE / 2);
+			auto const REPLAN = [&](std::function<PathCost(Graph::edge_type, Graph::edge_type)> const &replan)
+			{
+				std::vector<PathCost> original;
+				PathCost total(0);
+				for(unsigned i(0); i != changed.size(); ++i)
+				{
+					original.push_back(G.weight(changed[i].first));
+					G.set_weight(changed[i].first, weights[i]);
+					G.set_weight(changed[i].second, weights[i]);
+					total += replan(changed[i].first, changed[i].second);
+				}
+				for(unsigned i(changed.size()); i-- != 0; )
+				{
+					G.set_weight(changed[i].first, original[i]);
+					G.set_weight(changed[i].second, original[i]);
+				}
+				return total;
+			};
+
+			bench::run<PathCost>("random", "replan", SIZE, BRANCHING, SEED, 1, [&](statistics<PathCost> &stats)
+			{
+				incremental_search<ReplanningProblem, CostFunction, PriorityQueue, Table> planner(REPLANNING);
+				std::vector<Random::state> path;
+				planner.search(std::back_inserter(path));
+				return REPLAN([&](Graph::edge_type const EDGE, Graph::edge_type const REVERSE)
+				{
+					auto const U(G.target(REVERSE)), V(G.target(EDGE));
+					planner.edge_changed(U, V);
+					planner.edge_changed(V, U);
+					path.clear();
+					return planner.search(std::back_inserter(path), stats);
+				});
+			});
+
+			bench::run<PathCost>("random", "replan-scratch", SIZE, BRANCHING, SEED, 1, [&](statistics<PathCost> &stats)
+			{
+				std::vector<Random::state> path;
+				return REPLAN([&](Graph::edge_type, Graph::edge_type)
+				{
+					path.clear();
+					return context.search(0, SIZE / 2, std::back_inserter(path), stats);
+				});
+			});
+		}
+	}
+}
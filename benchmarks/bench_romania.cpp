@@ -0,0 +1,288 @@
+/*
+    bench_romania.cpp: Benchmark the search functions on the Romania problem.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Romania.hpp"
+#include "anytimesearch.hpp"
+#include "beamsearch.hpp"
+#include "bestfirstsearch.hpp"
+#include "bidirectionalsearch.hpp"
+#include "budget.hpp"
+#include "iterativedeepeningsearch.hpp"
+#include "memoryboundedsearch.hpp"
+#include "partialexpansionsearch.hpp"
+#include "trace.hpp"
+#include "benchmark.hpp"
+
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/heap/d_ary_heap.hpp>
+
+using namespace jsearch;
+
+typedef Romania::pathcost PathCost;
+typedef Problem<Romania, Distance, Neighbours, Visit, GoalTest, ArenaNodeCreator> RomaniaProblem;
+typedef BidirectionalProblem<Romania, Distance, Neighbours, Visit, GoalTest, Roads, ArenaNodeCreator> RomaniaBidirectionalProblem;
+
+
+// Romania with nodes that carry their own f, for EvaluatingNodeCreator.
+struct EvaluatedRomania : Romania
+{
+	typedef EvaluatedNode<EvaluatedRomania> *node;
+};
+
+// MapDistance without its batch_heuristic, so that each child is evaluated on its own.
+template <typename Traits>
+class MapDistanceOneByOne : public MapDistance<Traits> {};
+
+// MapDistance for only the nodes that reach the top of the frontier.
+template <typename Traits>
+class LazyMapDistance : public MapDistance<Traits> {};
+
+namespace jsearch
+{
+	template <>
+	struct lazy_heuristic<LazyMapDistance> : std::true_type {};
+}
+
+template <typename Traits>
+using MapCostFunction = AStar<Traits, MapDistance>;
+
+template <typename Traits>
+using OneByOneCostFunction = AStar<Traits, MapDistanceOneByOne>;
+
+template <typename Traits>
+using LazyCostFunction = AStar<Traits, LazyMapDistance>;
+
+template <typename Traits>
+using BatchNodeCreator = EvaluatingNodeCreator<Traits, MapCostFunction, FalseTiePolicy, ArenaNodeCreator>;
+
+template <typename Traits>
+using OneByOneNodeCreator = EvaluatingNodeCreator<Traits, OneByOneCostFunction, FalseTiePolicy, ArenaNodeCreator>;
+
+template <typename Traits>
+using LazyNodeCreator = EvaluatingNodeCreator<Traits, LazyCostFunction, FalseTiePolicy, ArenaNodeCreator>;
+
+typedef Problem<EvaluatedRomania, Distance, Neighbours, Visit, GoalTest, BatchNodeCreator> BatchProblem;
+typedef Problem<EvaluatedRomania, Distance, Neighbours, Visit, GoalTest, OneByOneNodeCreator> OneByOneProblem;
+typedef Problem<EvaluatedRomania, Distance, Neighbours, Visit, GoalTest, LazyNodeCreator> LazyProblem;
+
+
+template <typename Traits>
+using CostFunction = AStar<Traits, EuclideanDistance>;
+
+template <typename Traits>
+using WeightedCostFunction = WeightedAStar<Traits, EuclideanDistance>;
+
+template <typename Traits>
+using TieBreaker = LowH<Traits, EuclideanDistance>;
+
+template <typename Traits>
+using Comparator = TiebreakingComparator<Traits, CostFunction, TieBreaker>;
+
+template <typename T, typename Comp>
+using PriorityQueue = boost::heap::d_ary_heap<T, boost::heap::mutable_<true>, boost::heap::arity<2>, boost::heap::compare<Comp>>;
+
+template <typename T>
+using RBFSPriorityQueue = boost::heap::d_ary_heap<T, boost::heap::mutable_<true>, boost::heap::arity<2>>;
+
+template <typename Key, typename Value>
+using Map = std::unordered_map<Key, Value>;
+
+template <typename T>
+using ClosedList = std::unordered_set<T>;
+
+template <typename Key, typename Value>
+using Table = state_table<Key, Value>;
+
+template <typename Traits>
+using EvaluatedComparator = CachedComparator<Traits>;
+
+
+int main()
+{
+	// The problem is tiny, so repeat it enough to be measurable.
+	unsigned const REPETITIONS(10000);
+	auto const SIZE(COST.size());
+
+	bench::header();
+
+	bench::run<PathCost>("romania", "graph", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		RomaniaProblem const PROBLEM("Arad");
+		std::vector<Romania::state> path;
+		return best_first_search<PriorityQueue, Comparator, ClosedList, Map>(PROBLEM, std::back_inserter(path), stats);
+	});
+
+	bench::run<PathCost>("romania", "table", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		RomaniaProblem const PROBLEM("Arad");
+		std::vector<Romania::state> path;
+		return best_first_search<PriorityQueue, Comparator, Table>(PROBLEM, std::back_inserter(path), stats);
+	});
+
+	// The same search with every event recorded, and the ring written out to a trace in memory after each.
+	spsc_ring<trace_event> ring(1 << 10);
+	std::ostringstream trace;
+	bench::run<PathCost>("romania", "table-traced", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		RomaniaProblem const PROBLEM("Arad");
+		std::vector<Romania::state> path;
+		auto const COST(best_first_search<PriorityQueue, Comparator, Table>(PROBLEM, std::back_inserter(path), tracing<Romania, statistics<PathCost> &>(ring, stats)));
+		trace.str(std::string());
+		write_trace(trace, ring);
+		return COST;
+	});
+
+	// A budget that stops A* before it reaches Bucharest, so the cost is that of the best node it expanded.
+	budget const LIMITS(budget().max_expansions(3));
+	bench::run<PathCost>("romania", "table-budget-3", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		RomaniaProblem const PROBLEM("Arad");
+		std::vector<Romania::state> path;
+		try
+		{
+			return best_first_search<PriorityQueue, Comparator, Table>(PROBLEM, std::back_inserter(path), budgeted<Romania, statistics<PathCost> &>(LIMITS, stats));
+		}
+		catch(budget_exhausted<Romania> const &EX)
+		{
+			if(EX.expanded() != LIMITS.expansions() || EX.path().empty() || EX.path().back() != PROBLEM.initial)
+				std::cerr << "table-budget-3: wrong expansions or path\n";
+			return EX.path_cost();
+		}
+	});
+
+	// The heuristic of the map's coordinates, for each child in turn and then for each expansion at once.
+	PathCost eager(0);
+	bench::run<PathCost>("romania", "table-map", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		OneByOneProblem const PROBLEM("Arad");
+		std::vector<Romania::state> path;
+		return eager = best_first_search<PriorityQueue, EvaluatedComparator, Table>(PROBLEM, std::back_inserter(path), stats);
+	});
+
+	// The same heuristic, put off until each node reaches the top of the frontier, for each kind of search.
+	auto const CHECK_LAZY = [&](std::string const &ALGORITHM, PathCost const COST)
+	{
+		if(COST != eager)
+			std::cerr << ALGORITHM << ": " << COST << " is not " << eager << "\n";
+		return COST;
+	};
+
+	bench::run<PathCost>("romania", "graph-map-lazy", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		LazyProblem const PROBLEM("Arad");
+		std::vector<Romania::state> path;
+		return CHECK_LAZY("graph-map-lazy", best_first_search<PriorityQueue, EvaluatedComparator, ClosedList, Map>(PROBLEM, std::back_inserter(path), stats));
+	});
+
+	bench::run<PathCost>("romania", "table-map-lazy", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		LazyProblem const PROBLEM("Arad");
+		std::vector<Romania::state> path;
+		return CHECK_LAZY("table-map-lazy", best_first_search<PriorityQueue, EvaluatedComparator, Table>(PROBLEM, std::back_inserter(path), stats));
+	});
+
+	bench::run<PathCost>("romania", "tree-map-lazy", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		LazyProblem const PROBLEM("Arad");
+		return CHECK_LAZY("tree-map-lazy", best_first_search<PriorityQueue, EvaluatedComparator>(PROBLEM, stats)->path_cost());
+	});
+
+	bench::run<PathCost>("romania", "table-map-batch", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		BatchProblem const PROBLEM("Arad");
+		std::vector<Romania::state> path;
+		return best_first_search<PriorityQueue, EvaluatedComparator, Table>(PROBLEM, std::back_inserter(path), stats);
+	});
+
+	bench::run<PathCost>("romania", "partial", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		RomaniaProblem const PROBLEM("Arad");
+		std::vector<Romania::state> path;
+		return partial_expansion_search<CostFunction, PriorityQueue, Table>(PROBLEM, std::back_inserter(path), stats);
+	});
+
+	bench::run<PathCost>("romania", "tree", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		RomaniaProblem const PROBLEM("Arad");
+		return best_first_search<PriorityQueue, Comparator>(PROBLEM, stats)->path_cost();
+	});
+
+	bench::run<PathCost>("romania", "rbfs", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		RomaniaProblem const PROBLEM("Arad");
+		return recursive_best_first_search<CostFunction, TieBreaker, RBFSPriorityQueue>(PROBLEM, stats)->path_cost();
+	});
+
+	bench::run<PathCost>("romania", "ida", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		RomaniaProblem const PROBLEM("Arad");
+		std::vector<Romania::state> path;
+		return iterative_deepening_search<CostFunction>(PROBLEM, std::back_inserter(path), stats);
+	});
+
+	bench::run<PathCost>("romania", "anytime", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		RomaniaProblem const PROBLEM("Arad");
+		std::vector<Romania::state> path;
+		return anytime_search<WeightedCostFunction, PriorityQueue, ClosedList, Map>(PROBLEM, weight_schedule(3, 1), std::back_inserter(path), [](PathCost, double, std::vector<Romania::state> const &){}, stats);
+	});
+
+	bench::run<PathCost>("romania", "bidirectional", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		RomaniaBidirectionalProblem const PROBLEM("Arad", "Bucharest");
+		std::vector<Romania::state> path;
+		return bidirectional_search<PriorityQueue, Map>(PROBLEM, std::back_inserter(path), stats);
+	});
+
+	// There is no straight-line distance to Arad, so the reverse search has only half of a heuristic.
+	bench::run<PathCost>("romania", "bidirectional-sld", SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+	{
+		RomaniaBidirectionalProblem const PROBLEM("Arad", "Bucharest");
+		std::vector<Romania::state> path;
+		return bidirectional_search<PriorityQueue, Map, EuclideanDistance>(PROBLEM, std::back_inserter(path), stats);
+	});
+
+	// A beam returns the best goal of the first layer that has one, which is Fagaras's 450 unless only
+	// the single best node of each layer is kept, and it is then by luck on the cheapest path.
+	for(std::size_t const WIDTH : {4u, 2u, 1u})
+	{
+		bench::run<PathCost>("romania", "beam-" + std::to_string(WIDTH), SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+		{
+			RomaniaProblem const PROBLEM("Arad");
+			std::vector<Romania::state> path;
+			return beam_search<Comparator, Table>(PROBLEM, WIDTH, std::back_inserter(path), stats);
+		});
+	}
+
+	// A* keeps 16 nodes, so the smaller limits trade re-expansions, and then optimality, for memory.
+	for(std::size_t const LIMIT : {16u, 14u, 10u})
+	{
+		bench::run<PathCost>("romania", "sma-" + std::to_string(LIMIT), SIZE, 0, 0, REPETITIONS, [&](statistics<PathCost> &stats)
+		{
+			RomaniaProblem const PROBLEM("Arad");
+			return memory_bounded_search<CostFunction, TieBreaker>(PROBLEM, LIMIT, stats)->path_cost();
+		});
+	}
+}
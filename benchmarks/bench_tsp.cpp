@@ -0,0 +1,156 @@
+/*
+    bench_tsp.cpp: Benchmark the search functions on random TSP instances.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TSP.hpp"
+#include "beamsearch.hpp"
+#include "bestfirstsearch.hpp"
+#include "iterativedeepeningsearch.hpp"
+#include "bucket_queue.hpp"
+#include "benchmark.hpp"
+
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <boost/heap/d_ary_heap.hpp>
+
+using namespace jsearch;
+
+typedef TSP::pathcost PathCost;
+
+
+template <typename Traits>
+using CostFunction = AStar<Traits, MinimalImaginableTour>;
+
+template <typename Traits>
+using TieBreaking = LowH<Traits, MinimalImaginableTour>;
+
+// The same evaluation with every h remembered, for the searches that reach a state more than once.
+template <typename Traits>
+using CachedTour = CachedHeuristic<Traits, MinimalImaginableTour>;
+
+template <typename Traits>
+using CachedCostFunction = AStar<Traits, CachedTour>;
+
+template <typename Traits>
+using CachedTieBreaking = LowH<Traits, CachedTour>;
+
+template <typename T, typename Comp>
+using PriorityQueue = bucket_queue<T, Comp>;
+
+template <typename T, typename Comp>
+using HeapPriorityQueue = boost::heap::d_ary_heap<T, boost::heap::arity<2>, boost::heap::compare<Comp>>;
+
+template <typename T>
+using RBFSPriorityQueue = boost::heap::d_ary_heap<T, boost::heap::mutable_<true>, boost::heap::arity<2>>;
+
+template <typename Traits>
+using NodeCreator = EvaluatingNodeCreator<Traits, CostFunction, TieBreaking, ComboNodeCreator>;
+
+template <typename Traits>
+using Comparator = CachedComparator<Traits>;
+
+typedef Problem<TSP, EdgeCost, HigherCostValidEdges, AppendEdge, ValidTour, NodeCreator> TSPProblem;
+
+// TSP with a 64-bit f, which EvaluatedNode cannot pack with its key, to measure what packing saves.
+struct WideTSP : TSP
+{
+	typedef unsigned long long cost;
+	typedef std::shared_ptr<EvaluatedNode<WideTSP, ComboNode>> node;
+};
+
+typedef Problem<WideTSP, EdgeCost, HigherCostValidEdges, AppendEdge, ValidTour, NodeCreator> WideTSPProblem;
+
+
+int main()
+{
+	bench::header();
+
+	// Each TSP state is the whole partial tour and its nodes have no parent, so there is no graph search.
+	for(unsigned const SIZE : {8u, 10u, 12u})
+	{
+		for(unsigned const SEED : {1u, 2u, 3u})
+		{
+			Instance const INSTANCE(procedural(SIZE, SEED));
+
+			bench::run<PathCost>("tsp", "tree", SIZE, SIZE - 1, SEED, 1, [&](statistics<PathCost> &stats)
+			{
+				TSPProblem const PROBLEM((TSP::state(INSTANCE)));
+				return best_first_search<PriorityQueue, Comparator>(PROBLEM, stats)->path_cost();
+			});
+
+			// A binary heap compares nodes far more often than the buckets do, with f and key packed or not.
+			// One search is too quick to time, so each is repeated.  The two are within noise of each other,
+			// since the comparisons are cheap beside computing h for each child.
+			unsigned const REPETITIONS(200);
+			bench::run<PathCost>("tsp", "tree-heap", SIZE, SIZE - 1, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				TSPProblem const PROBLEM((TSP::state(INSTANCE)));
+				return best_first_search<HeapPriorityQueue, Comparator>(PROBLEM, stats)->path_cost();
+			});
+
+			bench::run<PathCost>("tsp", "tree-heap-unpacked", SIZE, SIZE - 1, SEED, REPETITIONS, [&](statistics<PathCost> &stats)
+			{
+				WideTSPProblem const PROBLEM((TSP::state(INSTANCE)));
+				return best_first_search<HeapPriorityQueue, Comparator>(PROBLEM, stats)->path_cost();
+			});
+
+			bench::run<PathCost>("tsp", "rbfs", SIZE, SIZE - 1, SEED, 1, [&](statistics<PathCost> &stats)
+			{
+				TSPProblem const PROBLEM((TSP::state(INSTANCE)));
+				return recursive_best_first_search<CostFunction, TieBreaking, RBFSPriorityQueue>(PROBLEM, stats)->path_cost();
+			});
+
+			bench::run<PathCost>("tsp", "ida", SIZE, SIZE - 1, SEED, 1, [&](statistics<PathCost> &stats)
+			{
+				TSPProblem const PROBLEM((TSP::state(INSTANCE)));
+				std::vector<TSP::state> path;
+				return iterative_deepening_search<CostFunction>(PROBLEM, std::back_inserter(path), stats);
+			});
+
+			// Every tour is as deep as every other, so a narrow beam finds one in SIZE layers, but not the best.
+			for(std::size_t const WIDTH : {16u, 256u})
+			{
+				bench::run<PathCost>("tsp", "beam-" + std::to_string(WIDTH), SIZE, SIZE - 1, SEED, 1, [&](statistics<PathCost> &stats)
+				{
+					TSPProblem const PROBLEM((TSP::state(INSTANCE)));
+					return beam_search<Comparator>(PROBLEM, WIDTH, stats)->path_cost();
+				});
+			}
+
+			// Tours are told apart by the address of their instance, which this one may share with the last.
+			CachedTour<TSP>::clear();
+
+			bench::run<PathCost>("tsp", "rbfs-cached", SIZE, SIZE - 1, SEED, 1, [&](statistics<PathCost> &stats)
+			{
+				TSPProblem const PROBLEM((TSP::state(INSTANCE)));
+				return recursive_best_first_search<CachedCostFunction, CachedTieBreaking, RBFSPriorityQueue>(PROBLEM, stats)->path_cost();
+			});
+
+			bench::run<PathCost>("tsp", "ida-cached", SIZE, SIZE - 1, SEED, 1, [&](statistics<PathCost> &stats)
+			{
+				TSPProblem const PROBLEM((TSP::state(INSTANCE)));
+				std::vector<TSP::state> path;
+				return iterative_deepening_search<CachedCostFunction>(PROBLEM, std::back_inserter(path), stats);
+			});
+
+			std::cerr << "h cache hit rate: " << CachedTour<TSP>::hit_rate() << "\n";
+		}
+	}
+}
@@ -0,0 +1,137 @@
+/*
+    benchmark.hpp: Measurement harness shared by the benchmarks.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file benchmark.hpp
+ * @brief Run a search repeatedly and print one CSV row of measurements.
+ *
+ * Every benchmark prints rows with the columns of header(), so the output of all of them can be
+ * concatenated and compared from one version to the next.
+ *
+ * NOTE: This header replaces the global operator new to count allocations, so it must be included by
+ * exactly one translation unit of each benchmark.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "statistics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <sys/resource.h>
+
+namespace bench
+{
+	std::atomic<std::size_t> allocations(0); // The parallel searches allocate from every thread.
+
+
+	// Peak resident set size of the process so far, in kilobytes.
+	inline long peak_rss()
+	{
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return usage.ru_maxrss;
+	}
+
+
+	inline void header()
+	{
+		std::cout << "domain,algorithm,size,branching,seed,repetitions,cost,expanded,seconds,nodes_per_sec,allocs_per_expansion,peak_rss_kb\n";
+	}
+
+
+	/**
+	 * @brief Call SEARCH(stats) REPETITIONS times and print the totals as a CSV row.
+	 *
+	 * SEARCH must do the whole search, including creating the Problem, and return the cost of the solution.
+	 */
+	template <typename Cost, typename Search>
+	void run(std::string const &DOMAIN, std::string const &ALGORITHM, std::size_t const SIZE, std::size_t const BRANCHING, unsigned const SEED, unsigned const REPETITIONS, Search search)
+	{
+		jsearch::statistics<Cost> stats;
+		Cost cost(0);
+		auto const ALLOCATIONS(allocations.load());
+
+		for(unsigned i(0); i != REPETITIONS; ++i)
+			cost = search(stats);
+
+		auto const ALLOCATED(allocations.load() - ALLOCATIONS);
+		auto const EXPANDED(stats.nodes_expanded());
+
+		std::cout << DOMAIN << "," << ALGORITHM << "," << SIZE << "," << BRANCHING << "," << SEED << "," << REPETITIONS << ","
+			<< cost << "," << EXPANDED << "," << std::chrono::duration<double>(stats.elapsed()).count() << ","
+			<< stats.expansions_per_second() << "," << (EXPANDED ? double(ALLOCATED) / EXPANDED : 0) << ","
+			<< peak_rss() << "\n";
+	}
+}
+
+
+void *operator new(std::size_t const SIZE)
+{
+	bench::allocations.fetch_add(1, std::memory_order_relaxed);
+	if(void *const P = std::malloc(SIZE ? SIZE : 1))
+		return P;
+	throw std::bad_alloc();
+}
+
+
+void *operator new[](std::size_t const SIZE)
+{
+	return operator new(SIZE);
+}
+
+
+// GCC cannot tell that the operator new above is what allocated P.  The sized and array forms must be
+// replaced as well, or they would free what the counting operator new allocated some other way.
+#if defined(__GNUC__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *const P) noexcept
+{
+	std::free(P);
+}
+
+
+void operator delete(void *const P, std::size_t) noexcept
+{
+	std::free(P);
+}
+
+
+void operator delete[](void *const P) noexcept
+{
+	std::free(P);
+}
+
+
+void operator delete[](void *const P, std::size_t) noexcept
+{
+	std::free(P);
+}
+#if defined(__GNUC__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+#endif // BENCHMARK_H
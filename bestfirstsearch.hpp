@@ -26,33 +26,18 @@
 
 #include "evaluation.hpp"
 #include "problem.hpp"
-#include "utils/to_string.hpp"
+#include "statistics.hpp"
 #include "utils/queue_set.hpp"
+#include "utils/state_table.hpp"
 
 #include <algorithm>
 #include <stdexcept>
 #include <limits>
-
-#ifndef NDEBUG
-#include <iostream>
-#endif
+#include <type_traits>
+#include <vector>
 
 namespace jsearch
 {
-#ifdef STATISTICS
-	struct statistics
-	{
-		statistics() : popped(0), pushed(0), decreased(0), discarded(0) {}
-		size_t popped;
-		size_t pushed;
-		size_t decreased;
-		size_t discarded;
-	};
-	
-	statistics stats;
-#endif
-
-
 	namespace detail
 	{
 		/**
@@ -67,6 +52,132 @@ namespace jsearch
         }
 
 
+		/**
+		 * @brief Write the states from NODE back to the initial state to path.
+		 */
+		template <typename Output, typename Node>
+		inline Output unravel(Output path, Node node)
+		{
+			for(; node; node = node->parent())
+				*path++ = node->state();
+			return path;
+		}
+
+
+		/**
+		 * @brief What a state_table knows about a state: on the frontier, with its handle, or closed with its g.
+		 */
+		template <typename Handle, typename PathCost>
+		struct table_entry
+		{
+			table_entry() : open(false), handle(), g() {}
+
+			bool open;
+			Handle handle;
+			PathCost g;
+		};
+
+
+		/**
+		 * @brief Tell an Observer that a search has started, and that it has finished however it ends.
+		 */
+		template <class Observer>
+		class observation
+		{
+		public:
+			observation(Observer &OBSERVER) : observer(OBSERVER) { observer.started(); }
+			~observation() { observer.finished(); }
+
+		private:
+			Observer &observer;
+		};
+
+
+		/**
+		 * @brief Release the nodes of a search when it ends, however it ends, if the Problem owns them.
+		 */
+		template <class Problem>
+		class release_guard
+		{
+		public:
+			release_guard(Problem const &PROBLEM) : problem(PROBLEM) {}
+			~release_guard() { problem.release(); }
+
+		private:
+			Problem const &problem;
+		};
+
+
+		/**
+		 * @brief PROBLEM.refine(NODE), timed as phase::h if the Problem has anything to refine, so that the
+		 * other Problems are not charged for reading the clock.
+		 */
+		template <class Problem, class Observer>
+		inline bool refine(Problem const &PROBLEM, typename Problem::Node const &NODE, Observer &observer)
+		{
+			if(evaluates_lazily<Problem>::value || evaluates_in_batches<Problem>::value)
+				return observer.measure(phase::h, [&]{ return PROBLEM.refine(NODE); });
+			return PROBLEM.refine(NODE);
+		}
+
+
+		template <class Problem, typename Visitor, class Observer>
+		inline auto visit_actions(Problem const &PROBLEM, typename Problem::State const &STATE, Visitor &visit, Observer &, int) -> decltype(PROBLEM.actions(STATE, visit), void())
+		{
+			PROBLEM.actions(STATE, visit);
+		}
+
+
+		template <class Problem, typename Visitor, class Observer>
+		inline void visit_actions(Problem const &PROBLEM, typename Problem::State const &STATE, Visitor &visit, Observer &observer, long)
+		{
+			auto const ACTIONS(observer.measure(phase::actions, [&]{ return PROBLEM.actions(STATE); }));
+			for(auto const &ACTION : ACTIONS)
+				visit(ACTION);
+		}
+
+
+		/**
+		 * @brief Call VISIT(ACTION) for each action in STATE.
+		 *
+		 * An ActionsPolicy may provide actions(State, Visitor), which calls the visitor with each action, so
+		 * that the actions are never stored at all.  Otherwise actions(State) may return any range, such as a
+		 * std::vector or a csr_graph::edge_range.  Only the range form is timed as phase::actions, since the
+		 * visitor form generates the children as it goes.
+		 */
+		template <class Problem, typename Visitor, class Observer>
+		inline void for_each_action(Problem const &PROBLEM, typename Problem::State const &STATE, Visitor &&visit, Observer &observer)
+		{
+			visit_actions(PROBLEM, STATE, visit, observer, 0);
+		}
+
+
+		/**
+		 * @brief Create the child of S for each action whose successor KEEP accepts, evaluate them all with one
+		 * call of PROBLEM.evaluate(), and then call VISIT(CHILD) with each in turn.
+		 *
+		 * This is how a search expands S when the Problem evaluates in batches (see EvaluatingNodeCreator), so
+		 * that no child goes on the frontier before its f is known.  children is only a buffer, kept by the
+		 * search so that it is not allocated again for each expansion.
+		 */
+		template <class Problem, typename Keep, typename Visitor, class Observer>
+		inline void for_each_child_batch(Problem const &PROBLEM, typename Problem::Node const &S, std::vector<typename Problem::Node> &children, Keep &&keep, Visitor &&visit, Observer &observer)
+		{
+			typedef typename Problem::Action Action;
+
+			children.clear();
+			for_each_action(PROBLEM, S->state(), [&](Action const &ACTION)
+			{
+				auto const SUCCESSOR(observer.measure(phase::child, [&]{ return PROBLEM.result(S->state(), ACTION); }));
+				if(keep(SUCCESSOR))
+					children.push_back(observer.measure(phase::child, [&]{ return PROBLEM.child(S, ACTION, SUCCESSOR); }));
+			}, observer);
+			observer.measure(phase::h, [&]{ PROBLEM.evaluate(children.data(), children.size()); });
+			for(auto const &CHILD : children)
+				visit(CHILD);
+		}
+
+
         /**
 		* @brief Handle the fate of a child being added to the frontier.
 		*
@@ -75,8 +186,8 @@ namespace jsearch
 		* 				ii) CHILD if CHILD was added to the frontier, or
 		* 				iii) another element if CHILD replaced it on the frontier.
 		* */
-		template <class Frontier>
-        inline typename Frontier::value_type handle_child(Frontier &frontier, typename Frontier::const_reference const &CHILD)
+		template <class Frontier, class Observer>
+        inline typename Frontier::value_type handle_child(Frontier &frontier, typename Frontier::const_reference const &CHILD, Observer &observer)
 		{
             typename Frontier::value_type result(nullptr); // Initialize to nullptr since it might be a bald pointer.
 
@@ -87,35 +198,20 @@ namespace jsearch
                 auto const &DUPLICATE((IT->second)); // The duplicate on the frontier.
                 if(CHILD->path_cost() < (*DUPLICATE)->path_cost())
 				{
-	#ifndef NDEBUG
-                    std::cout << jwm::to_string(CHILD->state()) << ": replace " << (*DUPLICATE)->path_cost() << " with " << CHILD->path_cost() << ".\n";
-	#endif
-	#ifdef STATISTICS
-					++stats.decreased;
-	#endif
+					observer.decreased();
                     result = (*DUPLICATE); // Store a copy of the node that we are about to replace.
                     frontier.increase(DUPLICATE, CHILD); // The DECREASE-KEY operation is an increase because it is a max-heap.
                 }
 				else
 				{
-	#ifndef NDEBUG
-                    std::cout << jwm::to_string(CHILD->state()) << ": keep " << (*DUPLICATE)->path_cost() << " and throw away " << CHILD->path_cost() << ".\n";
-	#endif
-	#ifdef STATISTICS
-					++stats.discarded;
-	#endif
+					observer.discarded();
 				}
 			}
 			else
 			{
                 frontier.push(CHILD);
                 result = CHILD;
-	#ifndef NDEBUG
-                std::cout << "frontier <= " << jwm::to_string(CHILD->state()) << "\n";
-	#endif
-	#ifdef STATISTICS
-				++stats.pushed;
-	#endif
+				observer.pushed();
 			}
 
             return result;
@@ -151,56 +247,63 @@ namespace jsearch
 				template <typename Traits__> class ResultPolicy,
 				template <typename Traits__> class CreatePolicy>
 				class ChildPolicy = DefaultChildPolicy,
-            typename Output>
-	typename Traits::pathcost best_first_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Output path)
+            typename Output,
+			typename Observer = null_observer>
+	typename Traits::pathcost best_first_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Output path, Observer &&observer = Observer())
 	{
         typedef typename Traits::node Node;
 		typedef typename Traits::state State;
 		typedef typename Traits::action Action;
 		// typedef typename Traits::pathcost PathCost;
 
+        detail::release_guard<Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy>> const RELEASE(PROBLEM);
+        detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+        Comparator<Traits> const COMPARE;
         jsearch::queue_set<PriorityQueue<Node, Comparator<Traits>>, Map> frontier;
         Set<State> closed;
+        std::vector<Node> children; // Only used if the Problem evaluates in batches.
 
         frontier.push(PROBLEM.create(PROBLEM.initial, Node(), Action(), 0));
 
 		while(!frontier.empty())
 		{
             auto const S(detail::pop(frontier));
-#ifndef NDEBUG
-            std::cout << S->state() << " <= frontier\n";
-#endif
-#ifdef STATISTICS
-			++stats.popped;
-#endif
-            if(PROBLEM.goal_test(S->state()))
+            observer.popped();
+            if(detail::refine(PROBLEM, S, observer))
+            {
+                frontier.push(S); // Its f went up, so something else may now be better.
+                continue;
+            }
+            if(observer.measure(phase::goal_test, [&]{ return PROBLEM.goal_test(S->state()); }))
 			{
-#ifndef NDEBUG
-				std::cout << "frontier: " << frontier.size() << "\n";
-				std::cout << "closed: " << closed.size() << "\n";
-#endif
-                std::function<Output(Output &, Node const &)> unravel =  [&](Output &path, Node const &node)
-                                {
-                                    *path++ = node->state();
-                                    if(node->parent())
-                                        return unravel(path, node->parent());
-                                    else
-                                        return path;
-                                };
-                unravel(path, S);
+                detail::unravel(path, S);
                 return S->path_cost();
 			}
 			else
 			{
                 closed.insert(S->state());
-                auto const &ACTIONS(PROBLEM.actions(S->state()));
-                // TODO: Change to auto parameter declaration once C++14 is implemented.
-                std::for_each(std::begin(ACTIONS), std::end(ACTIONS), [&](Action const &ACTION)
+                observer.expanded(S, COMPARE);
+                if(detail::evaluates_in_batches<Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy>>::value)
+                {
+                    detail::for_each_child_batch(PROBLEM, S, children, [&](State const &SUCCESSOR)
+                    {
+                        return closed.find(SUCCESSOR) == std::end(closed);
+                    }, [&](Node const &CHILD)
+                    {
+                        detail::handle_child(frontier, CHILD, observer);
+                    }, observer);
+                }
+                else
                 {
-                    auto const &SUCCESSOR(PROBLEM.result(S->state(), ACTION));
-                    if(closed.find(SUCCESSOR) == std::end(closed))
-                        detail::handle_child(frontier, PROBLEM.child(S, ACTION, SUCCESSOR));
-                });
+                    // TODO: Change to auto parameter declaration once C++14 is implemented.
+                    detail::for_each_action(PROBLEM, S->state(), [&](Action const &ACTION)
+                    {
+                        auto const SUCCESSOR(observer.measure(phase::child, [&]{ return PROBLEM.result(S->state(), ACTION); }));
+                        if(closed.find(SUCCESSOR) == std::end(closed))
+                            detail::handle_child(frontier, observer.measure(phase::child, [&]{ return PROBLEM.child(S, ACTION, SUCCESSOR); }), observer);
+                    }, observer);
+                }
+                observer.sizes(frontier.size(), closed.size());
 			}
 		}
 
@@ -208,6 +311,210 @@ namespace jsearch
 	}
 
 
+	namespace detail
+	{
+		/**
+		 * @brief The loop of graph search with a unified state table, on a frontier and table that already
+		 * hold a search, so that it can be carried on from where it stopped.
+		 *
+		 * GOAL is called with each node that is popped and says whether it is a goal.  If anything throws
+		 * before a popped node has generated all of its children, e.g. an Observer that stops the search, the
+		 * node is put back on the frontier first, so that the frontier and table still hold the whole search.
+		 *
+		 * @return The goal node, or a null Node if the frontier ran out first.
+		 */
+		template <class Problem, class Frontier, class Table, typename GoalTest, class Evaluator, class Observer>
+		typename Problem::Node table_continue(Problem const &PROBLEM, GoalTest const &GOAL, Frontier &frontier, Table &table, Evaluator const &EVALUATOR, Observer &observer)
+		{
+			typedef typename Problem::Node Node;
+			typedef typename Problem::State State;
+			typedef typename Problem::Action Action;
+			typedef typename Table::mapped_type Entry;
+
+			std::vector<Node> children; // Only used if the Problem evaluates in batches.
+
+			while(!frontier.empty())
+			{
+				auto const S(detail::pop(frontier));
+				bool generated(false);
+				try
+				{
+					observer.popped();
+					if(detail::refine(PROBLEM, S, observer))
+					{
+						table.find(S->state())->handle = frontier.push(S);
+						continue;
+					}
+
+					if(observer.measure(phase::goal_test, [&]{ return GOAL(S); }))
+						return S;
+
+					Entry &closing(*table.find(S->state()));
+					closing.open = false;
+					closing.g = S->path_cost();
+
+					// Put CHILD on the frontier if its state is new, or in place of the duplicate if it is cheaper.
+					auto const place([&](Entry &entry, bool const INSERTED, Node const &CHILD)
+					{
+						if(INSERTED)
+						{
+							entry.open = true;
+							entry.handle = frontier.push(CHILD);
+							observer.pushed();
+						}
+						else if(CHILD->path_cost() < (*entry.handle)->path_cost())
+						{
+							frontier.increase(entry.handle, CHILD); // The DECREASE-KEY operation is an increase because it is a max-heap.
+							observer.decreased();
+						}
+						else
+							observer.discarded();
+					});
+
+					observer.expanded(S, EVALUATOR);
+					if(detail::evaluates_in_batches<Problem>::value)
+					{
+						// A closed successor is discarded before its child is made, and the rest are placed once evaluated.
+						detail::for_each_child_batch(PROBLEM, S, children, [&](State const &SUCCESSOR)
+						{
+							auto const *const KNOWN(table.find(SUCCESSOR));
+							if(KNOWN && !KNOWN->open)
+							{
+								observer.discarded();
+								return false;
+							}
+							return true;
+						}, [&](Node const &CHILD)
+						{
+							auto const INSERTED(table.insert(CHILD->state()));
+							place(*INSERTED.first, INSERTED.second, CHILD);
+						}, observer);
+					}
+					else
+					{
+						detail::for_each_action(PROBLEM, S->state(), [&](Action const &ACTION)
+						{
+							auto const SUCCESSOR(observer.measure(phase::child, [&]{ return PROBLEM.result(S->state(), ACTION); }));
+							auto *const KNOWN(table.find(SUCCESSOR));
+							if(KNOWN && !KNOWN->open)
+							{
+								observer.discarded();
+								return;
+							}
+
+							// A new state only goes in the table once its child is made, in case making it throws.
+							auto const CHILD(observer.measure(phase::child, [&]{ return PROBLEM.child(S, ACTION, SUCCESSOR); }));
+							if(KNOWN)
+								place(*KNOWN, false, CHILD);
+							else
+								place(*table.insert(SUCCESSOR).first, true, CHILD);
+						}, observer);
+					}
+					generated = true;
+					observer.sizes(frontier.size(), table.size() - frontier.size());
+				}
+				catch(...)
+				{
+					// Any children already pushed stay, and S will generate them again as duplicates.
+					if(!generated)
+					{
+						Entry &reopened(*table.find(S->state()));
+						reopened.open = true;
+						reopened.handle = frontier.push(S);
+					}
+					throw;
+				}
+			}
+
+			return Node();
+		}
+
+
+		// Put the node of INITIAL on a frontier and in a table that the caller provides, empty.
+		template <class Problem, class Frontier, class Table>
+		void table_start(Problem const &PROBLEM, typename Problem::State const &INITIAL, Frontier &frontier, Table &table)
+		{
+			typedef typename Problem::Node Node;
+			typedef typename Problem::Action Action;
+			typedef typename Table::mapped_type Entry;
+
+			auto const START(PROBLEM.create(INITIAL, Node(), Action(), 0));
+			Entry &initial(*table.insert(START->state()).first);
+			initial.open = true;
+			initial.handle = frontier.push(START);
+		}
+
+
+		/**
+		 * @brief Graph search with a unified state table from INITIAL, on a frontier and table that the caller
+		 * provides, empty, so that they can be reused.
+		 *
+		 * @return The goal node, or a null Node if the frontier ran out first.
+		 */
+		template <class Problem, class Frontier, class Table, typename GoalTest, class Evaluator, class Observer>
+		typename Problem::Node table_search(Problem const &PROBLEM, typename Problem::State const &INITIAL, GoalTest const &GOAL, Frontier &frontier, Table &table, Evaluator const &EVALUATOR, Observer &observer)
+		{
+			table_start(PROBLEM, INITIAL, frontier, table);
+			return table_continue(PROBLEM, GOAL, frontier, table, EVALUATOR, observer);
+		}
+	}
+
+
+	/*****************************************
+	 *	Graph search with a unified state table	 *
+	 *****************************************/
+	/**
+	 * @brief Graph search that keeps the closed set and the frontier's state lookup in a single Table.
+	 *
+	 * Table is a map from State to an entry recording whether the state is on the frontier (with its handle
+	 * in the PriorityQueue) or closed (with its g), such as state_table.  Each successor costs one probe of
+	 * the table, and one more if it is new, and a child node is only created when the successor is new or
+	 * might replace a duplicate.
+	 * To answer many queries without building a new frontier and table each time, see search_context.
+	 *
+	 * @return The path cost of the goal.
+	 *
+	 * @throws goal_not_found
+	 */
+	template <template <typename T, typename Comparator> class PriorityQueue,
+			template <typename Traits> class Comparator,
+			template <typename Key, typename Value> class Table,
+			typename Traits,
+			template <typename Traits_> class StepCostPolicy,
+			template <typename Traits_> class ActionsPolicy,
+			template <typename Traits_> class ResultPolicy,
+			template <typename Traits_> class GoalTestPolicy,
+			template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy,
+				template <typename Traits__> class ResultPolicy,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy,
+			typename Output,
+			typename Observer = null_observer>
+	typename Traits::pathcost best_first_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Output path, Observer &&observer = Observer())
+	{
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+		typedef typename Traits::pathcost PathCost;
+		typedef PriorityQueue<Node, Comparator<Traits>> Frontier;
+		typedef detail::table_entry<typename Frontier::handle_type, PathCost> Entry;
+
+		detail::release_guard<Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy>> const RELEASE(PROBLEM);
+		detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+		Comparator<Traits> const COMPARE;
+		Frontier frontier;
+		Table<State, Entry> table;
+
+		auto const GOAL(detail::table_search(PROBLEM, PROBLEM.initial, [&](Node const &NODE){ return PROBLEM.goal_test(NODE->state()); }, frontier, table, COMPARE, observer));
+		if(!GOAL)
+			throw goal_not_found();
+
+		detail::unravel(path, GOAL);
+		return GOAL->path_cost();
+	}
+
+
 	/**************************
 	 *		Tree search		  *
 	 **************************/
@@ -223,8 +530,9 @@ namespace jsearch
 				template <typename Traits__> class StepCostPolicy,
 				template <typename Traits__> class ResultPolicy,
 				template <typename Traits__> class CreatePolicy>
-				class ChildPolicy = DefaultChildPolicy>
-	typename Traits::node best_first_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM)
+				class ChildPolicy = DefaultChildPolicy,
+			typename Observer = null_observer>
+	typename Traits::node best_first_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Observer &&observer = Observer())
 	{
 		typedef typename Traits::node Node;
 		// typedef typename Traits::state State;
@@ -233,28 +541,46 @@ namespace jsearch
 
 		typedef PriorityQueue<Node, Comparator<Traits>> Frontier;
 
+		detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+		Comparator<Traits> const COMPARE;
 		Frontier frontier;
+		std::vector<Node> children; // Only used if the Problem evaluates in batches.
 		frontier.emplace(PROBLEM.create(PROBLEM.initial, Node(), Action(), 0));
 
 		while(!frontier.empty())
 		{
             auto const S(detail::pop(frontier));
+			observer.popped();
+			if(detail::refine(PROBLEM, S, observer))
+			{
+				frontier.push(S);
+				continue;
+			}
 
-			if(PROBLEM.goal_test(S->state()))
+			if(observer.measure(phase::goal_test, [&]{ return PROBLEM.goal_test(S->state()); }))
 			{
-#ifndef NDEBUG
-				std::cout << "frontier: " << frontier.size() << "\n";
-#endif
 				return S;
 			}
 			else
 			{
-				auto const &ACTIONS(PROBLEM.actions(S->state()));
-                
-				std::for_each(std::begin(ACTIONS), std::end(ACTIONS), [&](Action const &action)
+				observer.expanded(S, COMPARE);
+				if(detail::evaluates_in_batches<Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy>>::value)
 				{
-                    frontier.emplace(PROBLEM.child(S, action));
-				});
+					detail::for_each_child_batch(PROBLEM, S, children, [](typename Traits::state const &){ return true; }, [&](Node const &CHILD)
+					{
+						frontier.emplace(CHILD);
+						observer.pushed();
+					}, observer);
+				}
+				else
+				{
+					detail::for_each_action(PROBLEM, S->state(), [&](Action const &action)
+					{
+						frontier.emplace(observer.measure(phase::child, [&]{ return PROBLEM.child(S, action); }));
+						observer.pushed();
+					}, observer);
+				}
+				observer.sizes(frontier.size(), 0);
 			}
 		}
 
@@ -284,9 +610,7 @@ namespace jsearch
 			 */
 			bool operator<(NodeCost<Traits, TiePolicy, PriorityQueue> const &OTHER) const
 			{
-				// Greater-than for max-heap.
-				auto const RESULT(cost_ == OTHER.cost_ ? split(node_, OTHER.node_) : (cost_ > OTHER.cost_ ? true : false));
-				return RESULT;
+				return less(OTHER, std::integral_constant<bool, detail::trivial_policy<TiePolicy<Traits>>::value>());
 			}
 
 			void update_cost(Cost const &COST) { cost_ = COST; }
@@ -294,21 +618,24 @@ namespace jsearch
 			handle_type handle; // TODO: Encapsulate.
 
 		private:
+			// A TiePolicy that never splits a tie leaves the cost to decide alone.
+			bool less(NodeCost<Traits, TiePolicy, PriorityQueue> const &OTHER, std::true_type) const
+			{
+				return cost_ > OTHER.cost_;
+			}
+
+			bool less(NodeCost<Traits, TiePolicy, PriorityQueue> const &OTHER, std::false_type) const
+			{
+				// Greater-than for max-heap.
+				auto const RESULT(cost_ == OTHER.cost_ ? split(node_, OTHER.node_) : (cost_ > OTHER.cost_ ? true : false));
+				return RESULT;
+			}
+
 			Node node_;
 			Cost cost_;
 		};
 
 
-#ifndef NDEBUG
-		template <typename Traits, template <typename Traits_> class TiePolicy, template <typename T> class PriorityQueue>
-		std::ostream& operator<<(std::ostream& stream, NodeCost<Traits, TiePolicy, PriorityQueue> const &O)
-		{
-			stream << "{" << *O.node() << ", " << O.cost() << "}";
-			return stream;
-		}
-#endif
-
-
 		/**
 		 * If SearchResult::first == nullptr then SearchResult::pathcost contains a valid value.
 		 * If SearchResult::first != nullptr then it is the goal node and SearchResult::second is undefined.
@@ -336,8 +663,9 @@ namespace jsearch
 				template <typename Traits__> class StepCostPolicy,
 				template <typename Traits__> class ResultPolicy,
 				template <typename Traits__> class CreatePolicy>
-				class ChildPolicy = DefaultChildPolicy>
-		SearchResult<Traits> recursive_best_first_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, CostFunction<Traits> const &COST, typename Traits::node const &NODE, typename Traits::pathcost const &F_N, typename Traits::pathcost const &B)
+				class ChildPolicy = DefaultChildPolicy,
+			class Observer>
+		SearchResult<Traits> recursive_best_first_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, CostFunction<Traits> const &COST, typename Traits::node const &NODE, typename Traits::pathcost const &F_N, typename Traits::pathcost const &B, Observer &observer)
 		{
 			// typedef typename Traits::node Node;
 			// typedef typename Traits::state State;
@@ -353,10 +681,6 @@ namespace jsearch
 			*
 			*	It is assumed that the algorithm used 1-offset arrays.
 			*/
-#ifndef NDEBUG
-			std::cerr << ">>> " << __FUNCTION__ << "(PROBLEM, COST, " << *NODE << ", " << F_N << ", " << B << ")\n";
-#endif
-
 // What I hope is a legitimate use of a macro.
 #ifndef RBFS_INF
 #define RBFS_INF	std::numeric_limits<PathCost>::max()
@@ -368,27 +692,28 @@ namespace jsearch
 				return RBFSResult(nullptr, f_N);
 
 			// IF N is a goal, EXIT algorithm
-			if(PROBLEM.goal_test(NODE->state()))
+			if(observer.measure(phase::goal_test, [&]{ return PROBLEM.goal_test(NODE->state()); }))
 				return RBFSResult(NODE, 0);
-			auto const ACTIONS(PROBLEM.actions(NODE->state()));
-
-			// IF N has no children, RETURN infinity
-			if(ACTIONS.empty())
-				return RBFSResult(nullptr, RBFS_INF);
+			observer.expanded(NODE, COST);
 
 			PriorityQueue<RBFSNodeCost> children;
 
 			// FOR each child Ni of N,
-			for(auto const ACTION : ACTIONS)
+			detail::for_each_action(PROBLEM, NODE->state(), [&](typename Traits::action const &ACTION)
 			{
-				auto const CHILD(PROBLEM.child(NODE, ACTION));
+				auto const CHILD(observer.measure(phase::child, [&]{ return PROBLEM.child(NODE, ACTION); }));
 				auto const f_CHILD(COST.f(CHILD));
 				// IF f(N)<F(N) THEN F[i] := MAX(F(N),f(Ni))
 				// ELSE F[i] := f(Ni)
 				auto const f_RESULT(f_N < F_N ? std::max(F_N, f_CHILD) : f_CHILD);
 				auto const HANDLE(children.push(RBFSNodeCost(CHILD, f_RESULT)));
 				(*HANDLE).handle = HANDLE; // Looks weird, makes sense.
-			}
+				observer.pushed();
+			}, observer);
+
+			// IF N has no children, RETURN infinity
+			if(children.empty())
+				return RBFSResult(nullptr, RBFS_INF);
 
 			// sort Ni and F[i] in increasing order of F[i]
 			/*	They sort automatically.	*/
@@ -404,7 +729,7 @@ namespace jsearch
 				auto const &BEST(*it++);
 				auto const SECOND_BEST_COST(it == children.ordered_end() ? RBFS_INF : it->cost());
 				// F[1] := RBFS(N1, F[1], MIN(B, F[2]))
-				auto const RESULT(recursive_best_first_search<CostFunction, TiePolicy, PriorityQueue>(PROBLEM, COST, BEST.node(), BEST.cost(), std::min(B, SECOND_BEST_COST)));
+				auto const RESULT(recursive_best_first_search<CostFunction, TiePolicy, PriorityQueue>(PROBLEM, COST, BEST.node(), BEST.cost(), std::min(B, SECOND_BEST_COST), observer));
 				if(!RESULT.first)
 					(*BEST.handle).update_cost(RESULT.second);
 				else
@@ -444,8 +769,9 @@ namespace jsearch
 			template <typename Traits__> class StepCostPolicy,
 			template <typename Traits__> class ResultPolicy,
 			template <typename Traits__> class CreatePolicy>
-			class ChildPolicy = DefaultChildPolicy>
-	typename Traits::node recursive_best_first_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM)
+			class ChildPolicy = DefaultChildPolicy,
+		typename Observer = null_observer>
+	typename Traits::node recursive_best_first_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Observer &&observer = Observer())
 	{
 		typedef typename Traits::node Node;
 		// typedef typename Traits::state State;
@@ -454,10 +780,11 @@ namespace jsearch
 
 
 		constexpr auto const INF(std::numeric_limits<PathCost>::max());
+		detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
 		auto initial(PROBLEM.create(PROBLEM.initial, Node(), Action(), 0));
 		CostFunction<Traits> const COST; // TODO: Design flaw?
 
-		auto const RESULT(recursive::recursive_best_first_search<CostFunction, TiePolicy, PriorityQueue>(PROBLEM, COST, initial, COST.f(initial), INF));
+		auto const RESULT(recursive::recursive_best_first_search<CostFunction, TiePolicy, PriorityQueue>(PROBLEM, COST, initial, COST.f(initial), INF, observer));
 
 		if(!RESULT.first)
 			throw goal_not_found();
@@ -0,0 +1,255 @@
+/*
+    bidirectionalsearch.hpp: Bidirectional Dijkstra and A* on explicit graphs.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file bidirectionalsearch.hpp
+ * @brief Search forwards from the initial state and backwards from the goal until the two searches meet.
+ */
+
+#ifndef BIDIRECTIONAL_SEARCH_H
+#define BIDIRECTIONAL_SEARCH_H
+
+#include "bestfirstsearch.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace jsearch
+{
+	namespace detail
+	{
+		/**
+		 * @brief Give a HeuristicPolicy a public h, so that two of them can be used side by side even if they
+		 * are the same policy.
+		 */
+		template <typename Traits, template <typename Traits_> class HeuristicPolicy>
+		class heuristic_of : protected HeuristicPolicy<Traits>
+		{
+		public:
+			heuristic_of() {}
+
+			using HeuristicPolicy<Traits>::h;
+		};
+
+
+		/**
+		 * @brief Order one frontier of bidirectional_search on the average of the two heuristics.
+		 *
+		 * The forward potential of a state is (h_goal - h_initial) / 2 and the reverse potential is its
+		 * negation, so keys are doubled to stay exact with integral costs, and signed since potentials can be
+		 * negative.  With consistent heuristics, both searches see non-negative reduced costs.
+		 */
+		template <typename Traits,
+				template <typename Traits_> class GoalHeuristic,
+				template <typename Traits_> class InitialHeuristic,
+				bool Forward>
+		class potential_comparator
+		{
+		public:
+			typedef typename Traits::node Node;
+			typedef typename Traits::state State;
+			typedef typename std::common_type<typename Traits::pathcost, long long>::type Key;
+
+			potential_comparator() {}
+
+			Key potential(State const &STATE) const
+			{
+				Key const P(Key(to_goal.h(STATE)) - Key(to_initial.h(STATE)));
+				return Forward ? P : -P;
+			}
+
+			Key key(Node const &N) const
+			{
+				return 2 * Key(N->path_cost()) + potential(N->state());
+			}
+
+			bool operator()(Node const &A, Node const &B) const
+			{
+				return key(A) > key(B);
+			}
+
+		private:
+			heuristic_of<Traits, GoalHeuristic> to_goal;
+			heuristic_of<Traits, InitialHeuristic> to_initial;
+		};
+
+
+		/**
+		 * @brief The node with which a search has reached KEY if it has, whether it is open or closed.
+		 */
+		template <class Frontier, class Closed>
+		inline typename Frontier::value_type reached(Frontier const &FRONTIER, Closed const &CLOSED, typename Frontier::key_type const &KEY)
+		{
+			auto const OPEN(FRONTIER.find(KEY));
+			if(OPEN != std::end(FRONTIER))
+				return *OPEN->second;
+			auto const DONE(CLOSED.find(KEY));
+			return DONE != std::end(CLOSED) ? DONE->second : typename Frontier::value_type(nullptr);
+		}
+
+
+		/**
+		 * @brief Let an Observer evaluate the nodes of either direction by their path cost.
+		 */
+		struct path_cost_evaluator
+		{
+			template <typename Node>
+			auto f(Node const &N) const -> decltype(N->path_cost()) { return N->path_cost(); }
+		};
+	}
+
+
+	/**************************************
+	 *	 	 Bidirectional search	 	  *
+	 **************************************/
+	/**
+	 * @brief Bidirectional Dijkstra, or A* with the average of two heuristics as potentials (Ikeda et al. 1994).
+	 *
+	 * One graph search goes forwards from PROBLEM.initial and one goes backwards from PROBLEM.goal through
+	 * PROBLEM.predecessors(), each with its own queue_set frontier and closed Map from state to node.  Each
+	 * step expands the smaller frontier.  Whenever a state is reached more cheaply in one direction and has
+	 * been reached in the other, their sum is a candidate for the best path, and the search stops as soon as
+	 * the top keys of the two frontiers add up to no less than the best candidate.
+	 *
+	 * GoalHeuristic estimates the cost from a state to the goal, as for A*, and InitialHeuristic the cost
+	 * from the initial state to a state.  They must both be consistent.  With the default ZeroHeuristic for
+	 * both, this is bidirectional Dijkstra.  GoalTestPolicy is not used, but the state PROBLEM.goal must
+	 * pass it for the Problem to mean the same to the other searches.
+	 *
+	 * Reverse nodes are created by PROBLEM.create() with their parent in the reverse search and a
+	 * default-constructed action.
+	 *
+	 * @return The path cost of the goal, whose path is written from the goal back to the initial state.
+	 *
+	 * @throws goal_not_found
+	 */
+	template <template <typename T, typename Comparator> class PriorityQueue,
+			template <typename Key, typename Value> class Map,
+			template <typename Traits_> class GoalHeuristic = ZeroHeuristic,
+			template <typename Traits_> class InitialHeuristic = ZeroHeuristic,
+			typename Traits,
+			template <typename Traits_> class StepCostPolicy,
+			template <typename Traits_> class ActionsPolicy,
+			template <typename Traits_> class ResultPolicy,
+			template <typename Traits_> class GoalTestPolicy,
+			template <typename Traits_> class ReversePolicy,
+			template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy,
+				template <typename Traits__> class ResultPolicy,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy,
+			typename Output,
+			typename Observer = null_observer>
+	typename Traits::pathcost bidirectional_search(BidirectionalProblem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, ReversePolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Output path, Observer &&observer = Observer())
+	{
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+		typedef typename Traits::action Action;
+		typedef typename Traits::pathcost PathCost;
+		typedef detail::potential_comparator<Traits, GoalHeuristic, InitialHeuristic, true> ForwardComparator;
+		typedef detail::potential_comparator<Traits, GoalHeuristic, InitialHeuristic, false> ReverseComparator;
+		typedef typename ForwardComparator::Key Key;
+
+		detail::release_guard<BidirectionalProblem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, ReversePolicy, CreatePolicy, ChildPolicy>> const RELEASE(PROBLEM);
+		detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+		ForwardComparator const FORWARD;
+		ReverseComparator const REVERSE;
+		detail::path_cost_evaluator const EVALUATOR;
+		jsearch::queue_set<PriorityQueue<Node, ForwardComparator>, Map> forward;
+		jsearch::queue_set<PriorityQueue<Node, ReverseComparator>, Map> reverse;
+		Map<State, Node> forward_closed, reverse_closed;
+
+		// The best path found so far goes through the state of both meeting nodes.
+		bool met(false);
+		PathCost best(std::numeric_limits<PathCost>::max());
+		Node forward_meeting(nullptr), reverse_meeting(nullptr);
+
+		// NODE reached its state more cheaply than before, so see whether it meets the other search there.
+		auto const MEET = [&](Node const &NODE, Node const &OTHER, bool const FROM_INITIAL)
+		{
+			if(OTHER && NODE->path_cost() + OTHER->path_cost() < best)
+			{
+				met = true;
+				best = NODE->path_cost() + OTHER->path_cost();
+				forward_meeting = FROM_INITIAL ? NODE : OTHER;
+				reverse_meeting = FROM_INITIAL ? OTHER : NODE;
+			}
+		};
+
+		forward.push(PROBLEM.create(PROBLEM.initial, Node(), Action(), 0));
+		reverse.push(PROBLEM.create(PROBLEM.goal, Node(), Action(), 0));
+		if(PROBLEM.initial == PROBLEM.goal)
+			MEET(forward.top(), reverse.top(), true);
+
+		while(!forward.empty() && !reverse.empty())
+		{
+			if(met && FORWARD.key(forward.top()) + REVERSE.key(reverse.top()) >= 2 * Key(best))
+				break;
+
+			observer.popped();
+			if(forward.size() <= reverse.size())
+			{
+				auto const S(detail::pop(forward));
+				forward_closed[S->state()] = S;
+				observer.expanded(S, EVALUATOR);
+				detail::for_each_action(PROBLEM, S->state(), [&](Action const &ACTION)
+				{
+					auto const SUCCESSOR(observer.measure(phase::child, [&]{ return PROBLEM.result(S->state(), ACTION); }));
+					if(forward_closed.find(SUCCESSOR) == std::end(forward_closed))
+					{
+						auto const CHILD(observer.measure(phase::child, [&]{ return PROBLEM.child(S, ACTION, SUCCESSOR); }));
+						if(detail::handle_child(forward, CHILD, observer))
+							MEET(CHILD, detail::reached(reverse, reverse_closed, SUCCESSOR), true);
+					}
+				}, observer);
+			}
+			else
+			{
+				auto const S(detail::pop(reverse));
+				reverse_closed[S->state()] = S;
+				observer.expanded(S, EVALUATOR);
+				PROBLEM.predecessors(S->state(), [&](State const &PREDECESSOR, PathCost const &COST)
+				{
+					if(reverse_closed.find(PREDECESSOR) == std::end(reverse_closed))
+					{
+						auto const CHILD(observer.measure(phase::child, [&]{ return PROBLEM.create(PREDECESSOR, S, Action(), S->path_cost() + COST); }));
+						if(detail::handle_child(reverse, CHILD, observer))
+							MEET(CHILD, detail::reached(forward, forward_closed, PREDECESSOR), false);
+					}
+				});
+			}
+			observer.sizes(forward.size() + reverse.size(), forward_closed.size() + reverse_closed.size());
+		}
+
+		if(!met)
+			throw goal_not_found();
+
+		// The reverse search's path runs from the meeting state to the goal, so write it backwards.
+		std::vector<State> to_goal;
+		for(auto node(reverse_meeting->parent()); node; node = node->parent())
+			to_goal.push_back(node->state());
+		detail::unravel(std::copy(to_goal.rbegin(), to_goal.rend(), path), forward_meeting);
+		return best;
+	}
+}
+
+#endif // BIDIRECTIONAL_SEARCH_H
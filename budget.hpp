@@ -0,0 +1,281 @@
+/*
+    budget.hpp: Limits on the expansions, time and memory of a search, and cancellation.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file budget.hpp
+ * @brief budgeted, an Observer that interrupts a search when its budget runs out or it is cancelled.
+ *
+ * Every search tells its Observer about each expansion, so a budget needs no support from the
+ * search functions:
+ *
+ *   budget const LIMITS(budget().max_expansions(100000).time_limit(std::chrono::milliseconds(50)));
+ *   try { best_first_search<...>(PROBLEM, path, budgeted<Traits>(LIMITS)); }
+ *   catch(budget_exhausted<Traits> const &EX) { ... EX.path(), EX.expanded() ... }
+ */
+
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#include "statistics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace jsearch
+{
+	/**
+	 * @brief A flag that one thread sets to stop the searches that another thread is running.
+	 */
+	class cancellation_token
+	{
+	public:
+		cancellation_token() : cancelled_(false) {}
+		cancellation_token(cancellation_token const &) = delete;
+		cancellation_token &operator=(cancellation_token const &) = delete;
+
+		void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+		void reset() { cancelled_.store(false, std::memory_order_relaxed); }
+		bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<bool> cancelled_;
+	};
+
+
+	/**
+	 * @brief How much a search may do before it is interrupted.  Every limit is unlimited by default.
+	 */
+	class budget
+	{
+	public:
+		typedef std::chrono::steady_clock clock;
+
+		budget() : expansions_(std::numeric_limits<std::size_t>::max()), nodes_(std::numeric_limits<std::size_t>::max()), deadline_(clock::time_point::max()), token_(nullptr) {}
+
+		// At most EXPANSIONS nodes expanded.
+		budget &max_expansions(std::size_t const EXPANSIONS) { expansions_ = EXPANSIONS; return *this; }
+
+		// At most NODES nodes on the frontier and in the closed set together, as the search reports them.
+		budget &max_nodes(std::size_t const NODES) { nodes_ = NODES; return *this; }
+
+		// Stop at DEADLINE, or LIMIT from now.
+		budget &until(clock::time_point const DEADLINE) { deadline_ = DEADLINE; return *this; }
+		budget &time_limit(clock::duration const LIMIT) { deadline_ = clock::now() + LIMIT; return *this; }
+
+		// Stop when TOKEN is cancelled.  TOKEN must outlive the searches that use this budget.
+		budget &cancelled_by(cancellation_token const &TOKEN) { token_ = &TOKEN; return *this; }
+
+		std::size_t expansions() const { return expansions_; }
+		std::size_t nodes() const { return nodes_; }
+		clock::time_point deadline() const { return deadline_; }
+		cancellation_token const *token() const { return token_; }
+
+	private:
+		std::size_t expansions_;
+		std::size_t nodes_;
+		clock::time_point deadline_;
+		cancellation_token const *token_;
+	};
+
+
+	/**
+	 * @brief Which part of a budget ran out.
+	 */
+	enum class interruption { expansions, nodes, deadline, cancelled };
+
+
+	/**
+	 * @brief search_interrupted is thrown when a search runs out of budget or is cancelled, with what the
+	 * search had done by then.
+	 */
+	class search_interrupted : public std::exception
+	{
+	public:
+		search_interrupted(interruption const REASON, std::size_t const EXPANDED, std::size_t const FRONTIER, std::size_t const CLOSED) : reason_(REASON), expanded_(EXPANDED), frontier_(FRONTIER), closed_(CLOSED) {}
+
+		char const *what() const noexcept
+		{
+			switch(reason_)
+			{
+				case interruption::expansions: return "search interrupted: too many expansions";
+				case interruption::nodes: return "search interrupted: too many nodes";
+				case interruption::deadline: return "search interrupted: deadline passed";
+				default: return "search interrupted: cancelled";
+			}
+		}
+
+		interruption reason() const { return reason_; }
+		std::size_t expanded() const { return expanded_; }
+
+		// The sizes of the frontier and the closed set that the search last reported.
+		std::size_t frontier() const { return frontier_; }
+		std::size_t closed() const { return closed_; }
+
+	private:
+		interruption reason_;
+		std::size_t expanded_, frontier_, closed_;
+	};
+
+
+	/**
+	 * @brief The search_interrupted thrown by budgeted, with the best node that had been expanded.
+	 *
+	 * The best node is the one that seemed closest to a goal: the lowest f - g, which is h for AStar, and
+	 * then the highest g, so that without a heuristic it is the node furthest from the initial state.
+	 * Since a CreatePolicy may release its nodes as the search unwinds, the node is kept as its path cost and
+	 * its path, from it back to the initial state.  The path is empty if the search does not give its
+	 * Observer nodes, as iterative_deepening_search does not.
+	 */
+	template <typename Traits>
+	class budget_exhausted : public search_interrupted
+	{
+	public:
+		typedef typename Traits::state State;
+		typedef typename Traits::pathcost PathCost;
+
+		budget_exhausted(interruption const REASON, std::size_t const EXPANDED, std::size_t const FRONTIER, std::size_t const CLOSED, std::vector<State> PATH, PathCost const &COST) : search_interrupted(REASON, EXPANDED, FRONTIER, CLOSED), path_(std::move(PATH)), path_cost_(COST) {}
+
+		std::vector<State> const &path() const { return path_; }
+		PathCost const &path_cost() const { return path_cost_; }
+
+	private:
+		std::vector<State> path_;
+		PathCost path_cost_;
+	};
+
+
+	/**
+	 * @brief Observer that enforces a budget on a search, and passes every call on to another Observer.
+	 *
+	 * The limits are checked when a node is about to be expanded and when the search reports its sizes,
+	 * which is where every search spends its time.  The clock is read only every CLOCK_INTERVAL expansions,
+	 * so a deadline may be overrun by that many expansions.  When a limit is reached, budget_exhausted<Traits> is thrown
+	 * from the search, which unwinds like goal_not_found.
+	 *
+	 * Observer may be a reference type, e.g. statistics<Cost> &, to keep its results after the search.
+	 */
+	template <typename Traits, class Observer = null_observer>
+	class budgeted
+	{
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+
+	public:
+		static std::size_t const CLOCK_INTERVAL = 64;
+
+		explicit budgeted(budget const &LIMITS) : limits(LIMITS), observer(), expanded_(0), frontier_(0), closed_(0), best(), best_to_go(0), have_best(false) {}
+		budgeted(budget const &LIMITS, Observer OBSERVER) : limits(LIMITS), observer(std::forward<Observer>(OBSERVER)), expanded_(0), frontier_(0), closed_(0), best(), best_to_go(0), have_best(false) {}
+
+		void started()
+		{
+			expanded_ = frontier_ = closed_ = 0;
+			have_best = false;
+			best = Node();
+			check(true);
+			observer.started();
+		}
+
+		void finished() { observer.finished(); }
+		void popped() { observer.popped(); }
+
+		template <typename N, typename Evaluator>
+		void expanded(N const &NODE, Evaluator const &EVALUATOR)
+		{
+			check(expanded_ % CLOCK_INTERVAL == 0);
+			remember(NODE, EVALUATOR, 0);
+			++expanded_;
+			observer.expanded(NODE, EVALUATOR);
+		}
+
+		void pushed() { observer.pushed(); }
+		void decreased() { observer.decreased(); }
+		void discarded() { observer.discarded(); }
+		void pruned() { observer.pruned(); }
+
+		void sizes(std::size_t const FRONTIER, std::size_t const CLOSED)
+		{
+			frontier_ = FRONTIER;
+			closed_ = CLOSED;
+			observer.sizes(FRONTIER, CLOSED);
+			if(FRONTIER + CLOSED > limits.nodes())
+				interrupt(interruption::nodes);
+		}
+
+		template <typename Cost>
+		void iteration(Cost const &THRESHOLD) { observer.iteration(THRESHOLD); }
+
+		template <typename F>
+		auto measure(phase const PHASE, F f) -> decltype(f()) { return observer.measure(PHASE, f); }
+
+		std::size_t nodes_expanded() const { return expanded_; }
+
+	private:
+		// Keep NODE if it is the best so far, if it is a Node at all.
+		template <typename N, typename Evaluator>
+		auto remember(N const &NODE, Evaluator const &EVALUATOR, int) -> decltype(Node(NODE), void())
+		{
+			double const TO_GO(double(EVALUATOR.f(NODE)) - double(NODE->path_cost()));
+			if(!have_best || TO_GO < best_to_go || (TO_GO == best_to_go && best->path_cost() < NODE->path_cost()))
+			{
+				best = NODE;
+				best_to_go = TO_GO;
+				have_best = true;
+			}
+		}
+
+		template <typename N, typename Evaluator>
+		void remember(N const &, Evaluator const &, long) {}
+
+		void check(bool const CLOCK)
+		{
+			if(expanded_ >= limits.expansions())
+				interrupt(interruption::expansions);
+			if(limits.token() && limits.token()->cancelled())
+				interrupt(interruption::cancelled);
+			if(CLOCK && limits.deadline() != budget::clock::time_point::max() && budget::clock::now() >= limits.deadline())
+				interrupt(interruption::deadline);
+		}
+
+		void interrupt(interruption const REASON)
+		{
+			std::vector<State> path;
+			typename Traits::pathcost cost(0);
+			if(have_best)
+			{
+				cost = best->path_cost();
+				for(Node node(best); node; node = node->parent())
+					path.push_back(node->state());
+			}
+			throw budget_exhausted<Traits>(REASON, expanded_, frontier_, closed_, std::move(path), cost);
+		}
+
+		budget const limits;
+		Observer observer;
+		std::size_t expanded_, frontier_, closed_;
+		Node best;
+		double best_to_go;
+		bool have_best;
+	};
+}
+
+#endif // BUDGET_H
@@ -25,17 +25,35 @@
 #ifndef EVALUATION_H
 #define EVALUATION_H
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
-
-#ifndef NDEBUG
-#include <iostream>
-#endif
+#include <type_traits>
+#include <vector>
 
 namespace jsearch
 {
+	namespace detail
+	{
+		/**
+		 * @brief Whether a HeuristicPolicy or TiePolicy has a public trivial member that is true, i.e. whether h is
+		 * zero everywhere or no tie is ever split, so that whatever is built on it can leave it out at compile time.
+		 */
+		template <class Policy, typename = void>
+		struct trivial_policy : std::false_type {};
+
+
+		template <class Policy>
+		struct trivial_policy<Policy, typename std::enable_if<Policy::trivial>::type> : std::true_type {};
+	}
+
+
 	template <typename Traits>
 	class ZeroHeuristic
 	{
+	public:
+		static constexpr bool trivial = true;
+
 	protected:
 		typedef typename Traits::state State;
 		typedef typename Traits::pathcost PathCost;
@@ -50,6 +68,113 @@ namespace jsearch
 	};
 
 
+	/**
+	 * CachedHeuristic remembers the h that HeuristicPolicy computed for each state, so that a state reached again
+	 * through another path, as in tree search and RBFS, need not be evaluated again.
+	 *
+	 * The cache is direct-mapped, with 2^Bits slots chosen by std::hash<State>, and a new state simply replaces
+	 * whichever state was in its slot.  Each thread has one cache for each instantiation, shared by every object
+	 * of the type, so its memory is capped and no locking is needed.  Call clear() if the values of h change, e.g.
+	 * because another problem instance is loaded, and use hits() and misses() to see whether the cache helps.
+	 */
+	template <typename Traits, template <typename Traits_> class HeuristicPolicy, unsigned Bits = 16>
+	class CachedHeuristic : protected virtual HeuristicPolicy<Traits>
+	{
+		static_assert(Bits > 0 && Bits < 32, "CachedHeuristic needs between 2 and 2^31 slots.");
+
+	public:
+		typedef typename Traits::state State;
+		typedef typename Traits::pathcost PathCost;
+
+		static void clear() { cache() = table(); }
+		static std::size_t hits() { return cache().hits; }
+		static std::size_t misses() { return cache().misses; }
+
+		static double hit_rate()
+		{
+			auto const &CACHE(cache());
+			auto const LOOKUPS(CACHE.hits + CACHE.misses);
+			return LOOKUPS ? double(CACHE.hits) / LOOKUPS : 0;
+		}
+
+	protected:
+		CachedHeuristic() {}
+		~CachedHeuristic() {}
+
+		PathCost h(State const &STATE) const
+		{
+			std::size_t const HASH(std::hash<State>()(STATE));
+			table &lookup(cache());
+			slot &cached(lookup.slots[index(HASH)]);
+
+			if(cached.valid && cached.hash == HASH && cached.state == STATE)
+			{
+				++lookup.hits;
+				return cached.h;
+			}
+
+			++lookup.misses;
+			cached.h = HeuristicPolicy<Traits>::h(STATE);
+			cached.state = STATE;
+			cached.hash = HASH;
+			cached.valid = true;
+			return cached.h;
+		}
+
+	private:
+		struct slot
+		{
+			slot() : state(), h(), hash(0), valid(false) {}
+
+			State state;
+			PathCost h;
+			std::size_t hash;
+			bool valid;
+		};
+
+		struct table
+		{
+			table() : slots(std::size_t(1) << Bits), hits(0), misses(0) {}
+
+			std::vector<slot> slots;
+			std::size_t hits, misses;
+		};
+
+		static table &cache()
+		{
+			static thread_local table t;
+			return t;
+		}
+
+		// Fibonacci hashing, so that the slot depends on every bit of a trivial hash like that of an integer.
+		static std::size_t index(std::size_t const HASH)
+		{
+			return static_cast<std::size_t>((static_cast<std::uint64_t>(HASH) * UINT64_C(11400714819323198485)) >> (64 - Bits));
+		}
+	};
+
+
+	/**
+	 * lazy_heuristic says whether a HeuristicPolicy is expensive enough to compute only for the nodes that reach
+	 * the top of the frontier.  Specialise it as std::true_type to make AStar, and so EvaluatingNodeCreator, lazy.
+	 */
+	template <template <typename Traits> class HeuristicPolicy>
+	struct lazy_heuristic : std::false_type {};
+
+
+	/**
+	 * batch_heuristic says whether a HeuristicPolicy also has
+	 *
+	 *   void h_batch(State const *STATES, std::size_t N, PathCost *h) const;
+	 *
+	 * which writes h of each of N states at once, e.g. with the kernels of distance_kernels.hpp.  Specialise it as
+	 * std::true_type to make AStar, and so EvaluatingNodeCreator, evaluate all of the children of an expansion
+	 * with one call of h_batch instead of one call of h each.
+	 */
+	template <template <typename Traits> class HeuristicPolicy>
+	struct batch_heuristic : std::false_type {};
+
+
 	template <typename Traits>
 	class DefaultPathCost
 	{
@@ -72,6 +197,10 @@ namespace jsearch
 	class LowH : protected virtual HeuristicPolicy<Traits>
 	{
 		using HeuristicPolicy<Traits>::h;
+
+	public:
+		// With no heuristic there is nothing to split ties on.
+		static constexpr bool trivial = detail::trivial_policy<HeuristicPolicy<Traits>>::value;
 		
 	protected:
 		typedef typename Traits::node Node;
@@ -87,6 +216,12 @@ namespace jsearch
             auto const Ah(h(A->state())), Bh(h(B->state()));
 			return Ah > Bh;
 		}
+
+		// The value that split() compares, for storing on the node (see CachedComparator).
+		PathCost key(Node const &N) const
+		{
+			return h(N->state());
+		}
 	};
 
 
@@ -117,6 +252,9 @@ namespace jsearch
 	template <typename Traits>
 	class FalseTiePolicy
 	{
+	public:
+		static constexpr bool trivial = true;
+
 	protected:
 		typedef typename Traits::node Node;
 
@@ -127,6 +265,11 @@ namespace jsearch
 		{
 			return false;
 		}
+
+		constexpr int key(Node const &) const
+		{
+			return 0;
+		}
 	};
 	
 
@@ -147,15 +290,93 @@ namespace jsearch
 
 	public: // Making this public so that it can be used flexibly.  Bad?
 		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
 		typedef typename Traits::cost Cost;
+		typedef typename Traits::pathcost PathCost;
+
+		// Whether EvaluatingNodeCreator should put off calling h (see lazy_heuristic).
+		static constexpr bool lazy = lazy_heuristic<HeuristicPolicy>::value;
+
+		// Whether EvaluatingNodeCreator should call f_batch once for each expansion (see batch_heuristic).
+		static constexpr bool batched = batch_heuristic<HeuristicPolicy>::value;
 
 		AStar() {}
 		~AStar() {}
 
 		Cost f(Node const &N) const
 		{
-            return g(N) + h(N->state());
+			return plus_h(g(N), N->state(), std::integral_constant<bool, TRIVIAL>());
+		}
+
+		// f of a state reached with path cost G, for searches that do not create nodes.
+		Cost f(State const &STATE, PathCost const &G) const
+		{
+			return plus_h(G, STATE, std::integral_constant<bool, TRIVIAL>());
+		}
+
+		// f of each of N STATES reached with path costs G, with one call of h_batch, if batched.
+		void f_batch(State const *STATES, PathCost const *G, std::size_t const N, Cost *f) const
+		{
+			static thread_local std::vector<PathCost> h; // Only ever grows, so expansions after the first allocate nothing.
+			h.resize(N);
+			this->h_batch(STATES, N, h.data());
+			for(std::size_t i(0); i != N; ++i)
+				f[i] = G[i] + h[i];
+		}
+
+	private:
+		// A ZeroHeuristic, say, is not called at all, so f is just g.
+		static constexpr bool TRIVIAL = detail::trivial_policy<HeuristicPolicy<Traits>>::value;
+
+		Cost plus_h(PathCost const &G, State const &, std::true_type) const
+		{
+			return G;
+		}
+
+		Cost plus_h(PathCost const &G, State const &STATE, std::false_type) const
+		{
+			return G + h(STATE);
+		}
+	};
+
+
+	/**	WeightedAStar: f(n) = g(n) + w·h(n), with the weight w set at run time, e.g. by anytime_search.
+	 */
+	template <typename Traits,
+			template <typename Traits_> class HeuristicPolicy = ZeroHeuristic,
+			template <typename Traits_> class PathCostPolicy = DefaultPathCost>
+	class WeightedAStar :
+			protected virtual HeuristicPolicy<Traits>,
+			protected virtual PathCostPolicy<Traits>
+	{
+		using PathCostPolicy<Traits>::g;
+		using HeuristicPolicy<Traits>::h;
+
+	public:
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+		typedef typename Traits::pathcost PathCost;
+		typedef double Cost; // A weight is rarely a whole number.
+
+		explicit WeightedAStar(double const WEIGHT = 1) : weight_(WEIGHT) {}
+		~WeightedAStar() {}
+
+		double weight() const { return weight_; }
+		void weight(double const WEIGHT) { weight_ = WEIGHT; }
+
+		Cost f(Node const &N) const
+		{
+			return g(N) + weight_ * h(N->state());
 		}
+
+		// The unweighted g + h, which is no more than the cost of any solution through N if h is admissible.
+		PathCost lower_bound(Node const &N) const
+		{
+			return g(N) + h(N->state());
+		}
+
+	private:
+		double weight_;
 	};
 
 
@@ -168,7 +389,9 @@ namespace jsearch
 
 	public:
 		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
 		typedef typename Traits::cost Cost;
+		typedef typename Traits::pathcost PathCost;
 
 		Greedy() {}
 		~Greedy() {}
@@ -178,6 +401,11 @@ namespace jsearch
 			// TODO: Need a conversion function from HeuristicCost to Cost?
             return h(N->state());
 		}
+
+		Cost f(State const &STATE, PathCost const &) const
+		{
+			return h(STATE);
+		}
 	};
 
 
@@ -190,7 +418,9 @@ namespace jsearch
 
 	public:
 		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
 		typedef typename Traits::cost Cost;
+		typedef typename Traits::pathcost PathCost;
 
 		Dijkstra() {}
 		~Dijkstra() {}
@@ -201,6 +431,11 @@ namespace jsearch
 			// TODO: Need a conversion function from PathCost to Cost?
 			return g(N);
 		}
+
+		Cost f(State const &, PathCost const &G) const
+		{
+			return G;
+		}
 	};
 
 
@@ -220,14 +455,28 @@ namespace jsearch
 									protected virtual TiePolicy<Traits>
 	{
 		using TiePolicy<Traits>::split;
-		using CostPolicy<Traits>::f;
 
 	public:
 		typedef typename Traits::node Node;
 
+		// Public so that priority queues can bucket nodes on f (see bucket_queue).
+		using CostPolicy<Traits>::f;
+
 		TiebreakingComparator() {}
 
 		bool operator()(Node const &A, Node const &B) const
+		{
+			return compare(A, B, std::integral_constant<bool, detail::trivial_policy<TiePolicy<Traits>>::value>());
+		}
+
+	private:
+		// A TiePolicy that never splits a tie, such as FalseTiePolicy, leaves f to decide alone.
+		bool compare(Node const &A, Node const &B, std::true_type) const
+		{
+			return f(A) > f(B);
+		}
+
+		bool compare(Node const &A, Node const &B, std::false_type) const
 		{
 			auto const Af(f(A)), Bf(f(B));
 			bool const RESULT(Af == Bf ? split(A, B) : Af > Bf);
@@ -236,16 +485,41 @@ namespace jsearch
 	};
 
 
+	/** CachedComparator compares the f and tie-breaking key stored on an EvaluatedNode by EvaluatingNodeCreator,
+	 * so nothing is evaluated during heap operations.  Ties on f go to the node with the lower key.  If Cost is an
+	 * integer of up to 32 bits, the node packs the two into one 64-bit integer, which is compared instead.
+	 */
+	template <typename Traits>
+	class CachedComparator
+	{
+	public:
+		typedef typename Traits::node Node;
+		typedef typename Traits::cost Cost;
+
+		CachedComparator() {}
+
+		Cost f(Node const &N) const
+		{
+			return N->f();
+		}
+
+		bool operator()(Node const &A, Node const &B) const
+		{
+			return A->after(*B);
+		}
+	};
+
+
 	/** SimpleComparator does not break ties, it just compares f(), and so uses the Dijkstra CostPolicy by default.
 	 */
 	template <typename Traits, template <typename Traits_> class CostPolicy = Dijkstra>
 	class SimpleComparator : protected virtual CostPolicy<Traits>
 	{
-		using CostPolicy<Traits>::f;
-
 	public:
 		typedef typename Traits::node Node;
 
+		using CostPolicy<Traits>::f;
+
 		SimpleComparator() {}
 
 		bool operator()(Node const &A, Node const &B) const
@@ -60,7 +60,7 @@ using ClosedList = std::unordered_set<T>;
 int main(int, char **)
 {
 	State const INITIAL("Arad");
-	Problem<Romania, Distance, Neighbours, Visit, GoalTest> const BUCHAREST(INITIAL); // The problem is to get to Bucharest.
+	Problem<Romania, Distance, Neighbours, Visit, GoalTest, ArenaNodeCreator> const BUCHAREST(INITIAL); // The problem is to get to Bucharest.
     list<Romania::state> path;
 
 	try
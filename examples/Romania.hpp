@@ -26,23 +26,23 @@
  */
 
 #include "problem.hpp"
+#include "evaluation.hpp"
+#include "distance_kernels.hpp"
 
 #include <unordered_map>
 #include <string>
 #include <algorithm>
+#include <cstddef>
+#include <utility>
 #include <vector>
 
-#define BOOST_RESULT_OF_USE_DECLTYPE
-
-#include <boost/iterator/transform_iterator.hpp>
-
 struct Romania
 {
 	typedef std::string state;
 	typedef std::string action;
 	typedef unsigned int cost;
 	typedef cost pathcost;
-	typedef std::shared_ptr<jsearch::DefaultNode<Romania>> node;
+	typedef jsearch::DefaultNode<Romania> *node; // Nodes live in the arena of ArenaNodeCreator.
 	typedef cost heuristic_cost; // Often but not necessarily the same as pathcost.
 };
 
@@ -89,6 +89,24 @@ std::unordered_map<Romania::state, Romania::heuristic_cost> const SLD {
 };
 
 
+// Position of each city on the map of AIMA, to the same scale as the roads.
+std::unordered_map<Romania::state, std::pair<double, double>> const LOCATION {
+	{"Arad", {91, 492}},
+	{"Bucharest", {400, 327}},
+	{"Craiova", {253, 288}},
+	{"Drobeta", {165, 299}},
+	{"Fagaras", {305, 449}},
+	{"Lugoj", {165, 379}},
+	{"Mehadia", {168, 339}},
+	{"Oradea", {131, 571}},
+	{"Pitesti", {320, 368}},
+	{"Rimnicu Vilcea", {233, 410}},
+	{"Sibiu", {207, 457}},
+	{"Timisoara", {94, 410}},
+	{"Zerind", {108, 531}},
+};
+
+
 // Simple StepCostPolicy that returns the road cost from city(STATE) to city(ACTION).
 template <typename Traits>
 class Distance
@@ -106,7 +124,7 @@ protected:
 };
 
 
-// ActionsPolicy returns neighbouring cities to STATE.
+// ActionsPolicy visits the neighbouring cities of STATE.
 template <typename Traits>
 class Neighbours
 {
@@ -115,16 +133,11 @@ public:
 	typedef typename Traits::action Action;
 	
 protected:
-	std::vector<Action> actions(State const &STATE) const
+	template <typename Visitor>
+	void actions(State const &STATE, Visitor &&visit) const
 	{
-        using namespace std;
-        using namespace std::placeholders;
-        
-		auto const &NGHBRS(COST.at(STATE));
-        auto const f(bind(&StateCost::value_type::first, _1));
-        auto x_begin(boost::make_transform_iterator(begin(NGHBRS), f)), x_end(boost::make_transform_iterator(end(NGHBRS), f));
-		
-		return vector<Action>(x_begin, x_end);
+		for(auto const &NEIGHBOUR : COST.at(STATE))
+			visit(NEIGHBOUR.first);
 	}
 };
 
@@ -172,3 +185,53 @@ protected:
 		return RESULT;
 	}
 };
+
+
+// HeuristicPolicy: the straight line to Bucharest measured on the map of LOCATION, rounded down.  No road is
+// shorter than the straight line between its cities, so this is consistent, if less informed than SLD.
+template <typename Traits>
+class MapDistance
+{
+public:
+	typedef typename Traits::state State;
+	typedef typename Traits::pathcost PathCost;
+
+protected:
+	PathCost h(State const &STATE) const
+	{
+		PathCost result;
+		h_batch(&STATE, 1, &result);
+		return result;
+	}
+
+	// h of N states at once (see jsearch::batch_heuristic), with one call of the distance kernel.
+	void h_batch(State const *STATES, std::size_t const N, PathCost *h) const
+	{
+		static thread_local std::vector<double> xs, ys, distances;
+		xs.resize(N);
+		ys.resize(N);
+		distances.resize(N);
+		for(std::size_t i(0); i != N; ++i)
+		{
+			auto const &POSITION(LOCATION.at(STATES[i]));
+			xs[i] = POSITION.first;
+			ys[i] = POSITION.second;
+		}
+		static auto const &TARGET(LOCATION.at("Bucharest"));
+		jsearch::euclidean_distances(xs.data(), ys.data(), N, TARGET.first, TARGET.second, distances.data());
+		for(std::size_t i(0); i != N; ++i)
+			h[i] = static_cast<PathCost>(distances[i]);
+	}
+};
+
+
+namespace jsearch
+{
+	template <>
+	struct batch_heuristic<MapDistance> : std::true_type {};
+}
+
+
+// ReversePolicy: every road goes both ways at the same cost, so the cities before STATE are its neighbours.
+template <typename Traits>
+using Roads = jsearch::Symmetric<Traits, Distance, Neighbours, Visit>;
@@ -36,6 +36,7 @@
 #include <boost/heap/fibonacci_heap.hpp>
 */
 #include <boost/heap/d_ary_heap.hpp>
+#include "utils/bucket_queue.hpp"
 
 #ifndef NDEBUG
 #include <boost/graph/graphviz.hpp>
@@ -47,17 +48,6 @@ using namespace std;
 using namespace jsearch;
 
 Graph Australia();
-Graph procedural(size_t const &n, mt19937::result_type const &SEED);
-
-
-struct EdgeDescComp
-{
-public:
-	bool operator()(edge_desc const &A, edge_desc const &B) const
-	{
-		return (*problem)[A] < (*problem)[B];
-	}
-};
 
 
 // Create template aliases that specify node evaluation.
@@ -67,16 +57,23 @@ using CostFunction = AStar<Traits, MinimalImaginableTour>;
 template <typename Traits>
 using TieBreaking = LowH<Traits, MinimalImaginableTour>;
 
+// Tour costs are integers, so bucket the frontier on f.  Any mutable Boost.Heap will also do, e.g.:
+// boost::heap::d_ary_heap<T, boost::heap::mutable_<true>, boost::heap::arity<2>, boost::heap::compare<Comp>>
 template <typename T, typename Comp>
-using PriorityQueue = boost::heap::d_ary_heap<T, boost::heap::mutable_<true>, boost::heap::arity<2>, boost::heap::compare<Comp>>;
+using PriorityQueue = bucket_queue<T, Comp>;
 
+// Evaluate each node once, when it is created, rather than in every comparison.
 template <typename Traits>
-using Comparator = TiebreakingComparator<Traits, CostFunction, TieBreaking>;
+using NodeCreator = EvaluatingNodeCreator<Traits, CostFunction, TieBreaking, ComboNodeCreator>;
+
+template <typename Traits>
+using Comparator = CachedComparator<Traits>;
 
 
 int main(int argc, char **argv)
 {
 	float weight = 10.0;
+	vertices_size_type n(0); // Number of cities.
 	mt19937::result_type seed(chrono::high_resolution_clock::to_time_t(chrono::high_resolution_clock::now()));
 	
 	// TODO: Use Program Options from Boost?
@@ -105,20 +102,35 @@ int main(int argc, char **argv)
 			break;
 	}
 
-	cout << "PriorityQueue: " << typeid(PriorityQueue<char, CostFunction<TSP>>).name() << "\n";
-	problem.reset(new Graph(procedural(n, seed)));
-	N = problem->m_num_edges;
-	EDGES.reserve(N);
-	pair<edge_iter, edge_iter> const EP(boost::edges(*problem));
-	transform(EP.first, EP.second, back_inserter(EDGES), [&](edge_desc const &E){ return E; });
-	sort(begin(EDGES), end(EDGES), EdgeDescComp());
+	cout << "PriorityQueue: " << typeid(PriorityQueue<TSP::node, Comparator<TSP>>).name() << "\n";
+	cout << "seed: " << seed << endl;
+	Instance const INSTANCE(procedural(n, seed));
+	Graph const &G(INSTANCE.graph());
+
+#ifndef NDEBUG
+	ofstream dot("TSP.dot");
+	boost::write_graphviz(dot, G, boost::default_writer(), boost::make_label_writer(boost::get(&EdgeProps::cost, G)));
+#endif
+
+	pair<vertex_iter, vertex_iter> const VP = boost::vertices(G);
+	cout << "vertices: ";
+	for (auto vi = VP.first; vi != VP.second; ++vi)
+		cout << *vi << " ";
+	cout << "" << endl;
+
+	// Verify that it worked.
+	cout << "edges: ";
+	edge_iter ei, ei_end;
+	for (tie(ei, ei_end) = boost::edges(G); ei != ei_end; ++ei)
+		cout << *ei << ": "<< G[*ei].cost << "  ";
+	cout << std::endl;
 
 #ifndef NDEBUG
-	cout << "Sorted edge descriptors: " << jwm::to_string(EDGES) << endl;
+	cout << "Sorted edge descriptors: " << jwm::to_string(vector<edge_desc>(INSTANCE.begin(), INSTANCE.end())) << endl;
 #endif
 	
-	TSP::state const INITIAL;
-	Problem<TSP, EdgeCost, HigherCostValidEdges, AppendEdge, ValidTour, ComboNodeCreator> const MINIMAL(INITIAL);
+	TSP::state const INITIAL(INSTANCE);
+	Problem<TSP, EdgeCost, HigherCostValidEdges, AppendEdge, ValidTour, NodeCreator> const MINIMAL(INITIAL);
 	cout.imbue(locale(""));
 	
 	try
@@ -126,8 +138,10 @@ int main(int argc, char **argv)
 		// Change this to WAStarTSP to use weighted A* (and adjust the weight above if desired).
 		auto const SOLUTION(jsearch::best_first_search<PriorityQueue, Comparator>(MINIMAL));
 
+		// The state iterates from its last edge, so reverse it to print the edges in the order they were added.
+		vector<TSP::action> const TOUR(begin(SOLUTION->state()), end(SOLUTION->state()));
 		cout << "solution: { ";
-		for_each(begin(SOLUTION->state()), end(SOLUTION->state()), [&](typename TSP::state::const_reference I)
+		for_each(TOUR.rbegin(), TOUR.rend(), [&](TSP::action const &I)
 		{
 			cout << *I << " ";
 		});
@@ -142,46 +156,6 @@ int main(int argc, char **argv)
 }
 
 
-Graph procedural(size_t const &n, mt19937::result_type const &SEED)
-{
-	vector<unsigned int> WEIGHT(n * (n - 1) / 2);
-	uniform_int_distribution<TSP::pathcost> distribution(1, 500);
-	cout << "seed: " << SEED << endl;
-	mt19937 const engine(SEED);
-	auto generator = bind(distribution, engine);
-	generate(begin(WEIGHT), end(WEIGHT), generator);
-	Graph g(n);
-
-	for(vertex_desc i = 0, k = 0; i < n - 1; ++i)
-	{
-		for(vertex_desc j = i + 1; j < n; ++j, ++k)
-		{
-			auto const E = boost::add_edge(i, j, EdgeProps(WEIGHT[k]), g);
-			if(!E.second)
-				cerr << "Failed to add edge " << E.first << "to the graph." << endl;
-		}
-	}
-
-#ifndef NDEBUG
-	ofstream dot("TSP.dot");
-	boost::write_graphviz(dot, g, boost::default_writer(), boost::make_label_writer(boost::get(&EdgeProps::cost, g)));
-#endif
-
-	pair<vertex_iter, vertex_iter> const VP = boost::vertices(g);
-	cout << "vertices: ";
-	for (auto vi = VP.first; vi != VP.second; ++vi)
-		cout << *vi << " ";
-	cout << "" << endl;
-
-	// Verify that it worked.
-	cout << "edges: ";
-	edge_iter ei, ei_end;
-	for (tie(ei, ei_end) = boost::edges(g); ei != ei_end; ++ei)
-		cout << *ei << ": "<< g[*ei].cost << "  ";
-	cout << std::endl;
-	
-	return g;
-}
 
 
 Graph Australia()
@@ -22,6 +22,7 @@
 #include "problem.hpp"
 #include "evaluation.hpp"
 #include "to_string.hpp"
+#include "persistent_sequence.hpp"
 
 #include <set>
 #include <vector>
@@ -32,15 +33,12 @@
 #include <memory>
 #include <stdexcept>
 #include <sstream>
-
-#ifndef NDEBUG
-#include <iostream>
-#endif
+#include <functional>
+#include <iterator>
+#include <random>
 
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/adjacency_matrix.hpp>
-#include <boost/graph/depth_first_search.hpp>
-#include <boost/graph/adjacency_list.hpp>
 
 using boost::adjacency_matrix;
 
@@ -85,20 +83,140 @@ typedef typename boost::graph_traits<Graph>::edge_descriptor edge_desc;
 
 typedef typename boost::graph_traits<Graph>::out_edge_iterator out_edge_iterator;
 
-vertices_size_type n; // Size of the TSP instance (number of cities).
-edges_size_type N; // Size of the TSP instance (number of edges).
+// Complete graph on n cities with edge costs drawn uniformly from [1, 500].
+inline Graph procedural(size_t const &n, std::mt19937::result_type const &SEED)
+{
+	std::vector<unsigned int> WEIGHT(n * (n - 1) / 2);
+	std::uniform_int_distribution<unsigned int> distribution(1, 500);
+	std::mt19937 const engine(SEED);
+	auto generator = std::bind(distribution, engine);
+	std::generate(std::begin(WEIGHT), std::end(WEIGHT), generator);
+	Graph g(n);
+
+	for(vertex_desc i = 0, k = 0; i < n - 1; ++i)
+	{
+		for(vertex_desc j = i + 1; j < n; ++j, ++k)
+		{
+			auto const E = boost::add_edge(i, j, EdgeProps(WEIGHT[k]), g);
+			if(!E.second)
+				throw std::logic_error("Failed to add edge to the graph.");
+		}
+	}
+
+	return g;
+}
+
+
+/* One TSP instance to solve: the graph, its edges sorted by cost, and the sum of the costs of the first i
+ * sorted edges for each i, so that the cost of any run of sorted edges is two lookups.  It is not changed
+ * after it is made, so any number of threads may search it, and each instance is separate from the others.
+ * Each state points to its instance, which must outlive the search.
+ */
+class Instance
+{
+public:
+	typedef std::vector<edge_desc>::const_iterator edge_iterator;
+
+	explicit Instance(Graph const &G) : graph_(G), n(boost::num_vertices(graph_)), N(graph_.m_num_edges)
+	{
+		edges_.reserve(N);
+		std::pair<edge_iter, edge_iter> const EP(boost::edges(graph_));
+		std::copy(EP.first, EP.second, std::back_inserter(edges_));
+		std::sort(std::begin(edges_), std::end(edges_), [&](edge_desc const &A, edge_desc const &B)
+		{
+			return graph_[A] < graph_[B];
+		});
+
+		prefix.reserve(N + 1);
+		prefix.push_back(0);
+		for(auto const &E : edges_)
+			prefix.push_back(prefix.back() + graph_[E].cost);
+	}
+
+	Instance(Instance const &) = delete;
+	Instance &operator=(Instance const &) = delete;
+
+	Graph const &graph() const { return graph_; }
+	vertices_size_type cities() const { return n; }
+	edges_size_type size() const { return N; }
+
+	// The edges in order of cost.
+	edge_iterator begin() const { return edges_.cbegin(); }
+	edge_iterator end() const { return edges_.cend(); }
+
+	unsigned int cost(edge_desc const &E) const { return graph_[E].cost; }
+
+	// The total cost of the COUNT sorted edges from FIRST.
+	unsigned int cost(edge_iterator const &FIRST, std::size_t const COUNT) const
+	{
+		auto const I(FIRST - edges_.cbegin());
+		return prefix[I + COUNT] - prefix[I];
+	}
+
+private:
+	Graph const graph_;
+	vertices_size_type const n; // Number of cities.
+	edges_size_type const N; // Number of edges.
+	std::vector<edge_desc> edges_;
+	std::vector<unsigned int> prefix; // prefix[i] is the total cost of the first i sorted edges.
+};
+
+
+// An action is an iterator into the sorted edges of an Instance, so hash the edge it refers to by its address.
+struct EdgeIteratorHash
+{
+	std::size_t operator()(Instance::edge_iterator const &E) const
+	{
+		return std::hash<edge_desc const *>()(&*E);
+	}
+};
+
+
+/* A partial tour: the edges chosen so far, in a persistent_sequence, and the Instance they are from, which
+ * is all that the policies need to know about the problem.
+ */
+class Tour : public jsearch::persistent_sequence<Instance::edge_iterator, EdgeIteratorHash>
+{
+public:
+	Tour() : instance_(nullptr) {}
+	explicit Tour(Instance const &INSTANCE) : instance_(&INSTANCE) {}
+
+	Instance const &instance() const { return *instance_; }
+
+	// As the instance is part of the state, tours of two instances are never the same, not even when empty.
+	std::size_t hash() const { return persistent_sequence::hash() ^ std::hash<Instance const *>()(instance_); }
+
+	friend bool operator==(Tour const &A, Tour const &B)
+	{
+		return A.instance_ == B.instance_ && static_cast<persistent_sequence const &>(A) == static_cast<persistent_sequence const &>(B);
+	}
+
+	friend bool operator!=(Tour const &A, Tour const &B) { return !(A == B); }
+
+private:
+	Instance const *instance_;
+};
+
+
+namespace std
+{
+	template <>
+	struct hash<Tour>
+	{
+		std::size_t operator()(Tour const &TOUR) const { return TOUR.hash(); }
+	};
+}
 
-std::unique_ptr<Graph> problem;
-std::vector<edge_desc> EDGES;
 
 // Problem definition
 struct TSP
 {
-	typedef typename std::vector<edge_desc>::const_iterator action;
-	typedef std::vector<action> state; // Why vector again?  Remind me?  Why not set?  Do I really need back()?
+	typedef Instance::edge_iterator action;
+	// Each child shares all of its parent's edges, and back() is the highest-cost edge.
+	typedef Tour state;
 	typedef unsigned int cost;
 	typedef unsigned int pathcost;
-	typedef std::shared_ptr<jsearch::ComboNode<TSP>> node;
+	typedef std::shared_ptr<jsearch::EvaluatedNode<TSP, jsearch::ComboNode>> node;
 };
 
 
@@ -116,17 +234,10 @@ protected:
 	
 	PathCost h(State const &STATE) const
 	{
-		// Expects edge costs to be ordered.
-		auto const EMPTY(STATE.empty());
-		auto const LAST(STATE.back());
-		auto const START(EMPTY ? std::begin(EDGES) : LAST + 1);
-		auto const END(START + n - STATE.size());
-
-		PathCost const RESULT(std::accumulate(START, END, 0, [&](PathCost const &A, edge_desc const &B)
-		{
-			return A + (*problem)[B].cost;
-		}));
-		
+		// The cheapest edges that could complete the tour are the next ones in order of cost.
+		auto const &INSTANCE(STATE.instance());
+		auto const START(STATE.empty() ? INSTANCE.begin() : STATE.back() + 1);
+		PathCost const RESULT(INSTANCE.cost(START, INSTANCE.cities() - STATE.size()));
 		return RESULT;
 	}
 };
@@ -144,9 +255,9 @@ protected:
 	EdgeCost() {}
 	~EdgeCost() {}
 	
-	PathCost step_cost(State const &, Action const &ACTION) const
+	PathCost step_cost(State const &STATE, Action const &ACTION) const
 	{
-		PathCost const RESULT((*problem)[*ACTION].cost);
+		PathCost const RESULT(STATE.instance().cost(*ACTION));
 		return RESULT;
 	}
 };
@@ -160,160 +271,101 @@ public:
 	typedef typename Traits::state State;
 	typedef typename Traits::action Action;
 
-private:
-	// subgraph is used for testing whether a given combination of edges form a valid subsection of a tour.
-	typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS> subgraph;
-	
 protected:
 	HigherCostValidEdges(){}
 	~HigherCostValidEdges(){}
 	
 	// I thought about returning a pair of iterators for a while until I realized that, derr, I could be
 	// returning any arbitray subset of the available actions, not a contiguous one.
-	// Although it looks like this functions returns a State, it doesn't.
-	std::vector<Action> actions(State const &STATE) const
+	// So instead, visit each valid action in turn.
+	template <typename Visitor>
+	void actions(State const &STATE, Visitor &&visit) const
 	{
-		std::vector<Action> result;
-		auto const START(STATE.empty() ? EDGES.cbegin() : STATE.back() + 1),
-					END(EDGES.cbegin() + N - n + STATE.size() + 1);
-#ifndef NDEBUG
-		std::cout << "Generating actions for state: {";
-		std::for_each(std::begin(STATE), std::end(STATE), [&](typename State::const_reference ACTION){ std::cout << *ACTION; });
-		std::cout << "}" << "\n";
-#endif
+		auto const &INSTANCE(STATE.instance());
+		auto const &G(INSTANCE.graph());
+		auto const n(INSTANCE.cities());
+		auto const START(STATE.empty() ? INSTANCE.begin() : STATE.back() + 1),
+					END(INSTANCE.begin() + INSTANCE.size() - n + STATE.size() + 1);
 		if(STATE.size() > 1)
 		{
-			// Create a graph containing all the edges in STATE.
-			subgraph subproblem;
+			/*	The edges in STATE form disjoint paths, since every state was generated by this function.
+			 *	So a candidate edge is valid if neither end already has degree 2, and if it does not join
+			 *	the two ends of one path, unless it is the edge that closes the tour.
+			 *	The counters are reused from one call to the next, so they are only allocated once per thread.	*/
+			static thread_local std::vector<unsigned char> degree;
+			static thread_local path_ends paths;
+			degree.assign(n, 0);
+			paths.reset(n);
 			
 			std::for_each(std::begin(STATE), std::end(STATE), [&](typename State::const_reference &E)
 			{
-				auto const SOURCE(boost::source(*E, *problem)),
-						   TARGET(boost::target(*E, *problem));
-				// Use the vertices from the main problem in the subproblem.
-				auto const RESULT(boost::add_edge(SOURCE, TARGET, subproblem));
-				if(!RESULT.second)
-				{
-					std::ostringstream tmp;
-					tmp << "  ERROR: Failed to add edge " << RESULT.first << " to subgraph.\n";
-					throw std::logic_error(tmp.str());
-				}
+				auto const SOURCE(boost::source(*E, G)),
+						   TARGET(boost::target(*E, G));
+				++degree[SOURCE];
+				++degree[TARGET];
+				paths.join(SOURCE, TARGET);
 			});
 			
+			bool const CLOSING(STATE.size() == n - 1);
 
 			for(auto edge(START); edge != END; ++edge)
 			{
-				// Add candidate action to the subgraph.
-				auto const SOURCE(boost::source(*edge, *problem)),
-							TARGET(boost::target(*edge, *problem));
-				auto const ADD_EDGE_RESULT(boost::add_edge(SOURCE, TARGET, subproblem));
-				if(!ADD_EDGE_RESULT.second)
-				{
-					std::ostringstream tmp;
-					tmp << "  ERROR: Failed to add edge " << ADD_EDGE_RESULT.first << " to subgraph.\n";
-					throw std::logic_error(tmp.str());
-				}
-				// Check the graph for validity.
-				bool valid(true);
-
-				auto degree(boost::out_degree(SOURCE, subproblem));
-				if(degree > 2)
-				{
-					valid = false;
-#ifndef NDEBUG
-					auto const EI(boost::out_edges(SOURCE, subproblem));
-					std::set<boost::graph_traits<subgraph>::edge_descriptor> const invalid(EI.first, EI.second);
-					std::cout << "  !invalid SOURCE edge: " << *edge << " on " << SOURCE << ". " << jwm::to_string(invalid) << "\n";
-#endif
-				}
-				else
-				{
-					degree = boost::out_degree(TARGET, subproblem);
-
-					if(degree > 2)
-					{
-						valid = false;
-#ifndef NDEBUG
-						auto const EI(boost::out_edges(TARGET, subproblem));
-						std::set<boost::graph_traits<subgraph>::edge_descriptor> const invalid(EI.first, EI.second);
-						std::cout << "  !invalid TARGET edge: " << *edge << " on " << TARGET << ". " << jwm::to_string(invalid) << "\n";
-#endif
-					}
-					else
-					{
-						if(STATE.size() != n - 1)
-						{
-							cycle_detector vis;
-
-							try
-							{
-								boost::depth_first_search(subproblem, boost::visitor(vis));
-							}
-							catch (found_cycle &ex)
-							{
-								valid = false;
-#ifndef NDEBUG
-								std::cout << "  !cycle found: " << *edge << "\n";
-#endif
-							}
-						}
-					}
-				}
-
-				// If valid, add action to result.
-				if(valid)
-				{
-#ifndef NDEBUG
-					std::cout << "  GOOD edge: " << *edge << "\n";
-#endif
-					result.push_back(edge);
-				}
-				// Remove action from subgraph.
-				boost::remove_edge(ADD_EDGE_RESULT.first, subproblem);
+				auto const SOURCE(boost::source(*edge, G)),
+							TARGET(boost::target(*edge, G));
+
+				// An end with degree 2 is full, and otherwise the edge must not close a cycle early.
+				if(degree[SOURCE] < 2 && degree[TARGET] < 2 && (CLOSING || paths.find(SOURCE) != paths.find(TARGET)))
+					visit(edge);
 			}
 		}
 		else
 		{
 			// All actions are theoretically valid.
 			for(auto edge(START); edge != END; ++edge)
-				result.push_back(edge);
+				visit(edge);
 		}
-
-#ifndef NDEBUG
-		std::vector<edge_desc> tmp;
-		tmp.reserve(result.size());
-		std::for_each(std::begin(result), std::end(result), [&](Action const &A){ tmp.push_back(*A); });
-		std::cout << "  Actions: " << jwm::to_string(tmp) << "\n";
-#endif
-		return result;
 	}
 
 private:
-	class found_cycle : public std::exception
+	// Disjoint-set forest of cities, where each set is the cities on one path of the partial tour.
+	class path_ends
 	{
 	public:
-		found_cycle(subgraph::edge_descriptor const &EDGE) : edge(EDGE) {};
-		subgraph::edge_descriptor const edge;
-	};
+		// Make every city a path on its own.
+		void reset(vertices_size_type const SIZE)
+		{
+			parent.resize(SIZE);
+			for(vertices_size_type i(0); i != SIZE; ++i)
+				parent[i] = i;
+			rank.assign(SIZE, 0);
+		}
 
-	struct cycle_detector : public boost::dfs_visitor<>
-	{
-		template <class Edge, class Graph>
-		void back_edge(Edge const &E, Graph&)
+		vertex_desc find(vertex_desc v)
 		{
-			// Throw an exception so that the algorithm stops searching.
-			if(predecessors.find(E) == std::end(predecessors))
-				throw found_cycle(E);
+			// Path halving.
+			while(parent[v] != v)
+			{
+				parent[v] = parent[parent[v]];
+				v = parent[v];
+			}
+			return v;
 		}
-		
-		template <class Edge, class Graph>
-		void tree_edge(Edge const &E, Graph &)
+
+		void join(vertex_desc const A, vertex_desc const B)
 		{
-			predecessors.insert(E);
+			auto a(find(A)), b(find(B));
+			if(a == b)
+				return;
+			if(rank[a] < rank[b])
+				std::swap(a, b);
+			parent[b] = a;
+			if(rank[a] == rank[b])
+				++rank[a];
 		}
+
 	private:
-		// TODO: Find a way to make this a hash/unordered set.
-		std::set<subgraph::edge_descriptor> predecessors;
+		std::vector<vertex_desc> parent;
+		std::vector<unsigned char> rank;
 	};
 };
 
@@ -353,7 +405,7 @@ protected:
 	
 	bool goal_test(State const &STATE) const
 	{
-		return STATE.size() == n;
+		return STATE.size() == STATE.instance().cities();
 	}
 };
 
@@ -18,19 +18,24 @@
 
 /**
  * @file gg.hpp
- * @brief Generate randomly weighted graphs of arbitrary size and branching factor in DOT format.
+ * @brief Generate randomly weighted graphs of arbitrary size and branching factor.
  */
 
 #include <random>
 #include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
 #include <type_traits>
 #include <algorithm>
 #include <stdexcept>
+#include <vector>
 #include <boost/graph/adjacency_matrix.hpp>
 
+#include "csr_graph.hpp"
+#include "csr_file.hpp"
+
 #ifndef NDEBUG
-#include <boost/graph/graphviz.hpp>
-#include <fstream>
 #include <iostream>
 #endif
 
@@ -100,6 +105,76 @@ namespace gg
 				throw std::logic_error("Sorry, an odd graph size with odd branching factor is not supported.");
 			}
 		}
+
+
+		/**
+		 * The weight of the edge numbered ID in the graph of SEED, in [1, 500] like the weights of
+		 * generate_graph.  It is a hash of the two (the finalizer of SplitMix64), rather than a draw from an
+		 * engine, so that any edge's weight can be known without the others.
+		 */
+		template <typename Weight>
+		Weight counter_weight(std::uint64_t const SEED, std::uint64_t const ID)
+		{
+			std::uint64_t x(SEED * 0x9e3779b97f4a7c15ull + ID + 1);
+			x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+			x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+			x ^= x >> 31;
+			return std::is_integral<Weight>::value ? Weight(1 + x % 500) : Weight(1 + (x >> 11) * (499.0 / 9007199254740992.0));
+		}
+
+
+		/**
+		 * Fill the rows of the vertices in [FIRST, LAST) of the graph of generate_csr_graph, but with the
+		 * weights of counter_weight.  ID numbers each undirected edge by the vertex it leaves to a higher
+		 * offset, so that both of its rows give it the same weight.
+		 */
+		template <typename Weight, typename Vertex, typename Edge>
+		void fill_csr_rows(std::size_t const N, unsigned const B, std::uint64_t const SEED, std::size_t const FIRST, std::size_t const LAST, Edge *offsets, Vertex *targets, Weight *weights)
+		{
+			auto const BODD(B % 2);
+			std::size_t const	END(N / 2 + BODD + N % 2),
+								START(END - B / 2 - BODD);
+			std::size_t const K(END - START);
+			bool const ANTIPODAL(N % 2 == 0 && END - 1 == N / 2);
+
+			// An antipodal edge is numbered by the lower of its two vertices.
+			auto const ID = [&](std::size_t const V, std::size_t const k)
+			{
+				return std::uint64_t(ANTIPODAL && k == K - 1 && V >= N / 2 ? V - N / 2 : V) * K + k;
+			};
+
+			for(std::size_t v(FIRST); v != LAST; ++v)
+			{
+				offsets[v] = v * B;
+				for(std::size_t k(0); k != K; ++k)
+				{
+					targets[v * B + k] = (v + START + k) % N;
+					weights[v * B + k] = counter_weight<Weight>(SEED, ID(v, k));
+				}
+				for(std::size_t k(0); k != K - (ANTIPODAL ? 1 : 0); ++k)
+				{
+					auto const U((v + N - START - k) % N);
+					targets[v * B + K + k] = U;
+					weights[v * B + K + k] = counter_weight<Weight>(SEED, ID(U, k));
+				}
+			}
+			if(LAST == N)
+				offsets[N] = N * B;
+		}
+
+
+		// Fill every row with fill_csr_rows, split evenly over THREADS threads.
+		template <typename Weight, typename Vertex, typename Edge>
+		void fill_csr(std::size_t const N, unsigned const B, std::uint64_t const SEED, unsigned const THREADS, Edge *offsets, Vertex *targets, Weight *weights)
+		{
+			unsigned const T(std::max(THREADS, 1u));
+			std::vector<std::thread> threads;
+			for(unsigned i(1); i < T; ++i)
+				threads.emplace_back([=]{ fill_csr_rows(N, B, SEED, N * i / T, N * (i + 1) / T, offsets, targets, weights); });
+			fill_csr_rows(N, B, SEED, 0, N / T, offsets, targets, weights);
+			for(auto &thread : threads)
+				thread.join();
+		}
 	}
 
 	
@@ -116,10 +191,105 @@ namespace gg
 		// Do the actual work.
 		Detail::construct(g, N, B, weight_generator);
 		assert(Detail::correct(g, B));
+	}
 
-#ifndef NDEBUG
-		std::ofstream gv_output("Random.dot");
-		boost::write_graphviz(gv_output, g, boost::default_writer(), boost::make_label_writer(boost::get(boost::edge_weight, g)));
-#endif
+
+	/**
+	 * @brief Generate the same graph as generate_graph, with the same weights for the same engine, in CSR form.
+	 *
+	 * Vertex V is joined to V ± i (mod N) for each i in [START, END), so every row has B edges: first the
+	 * edges to higher offsets, then the edges back.  Only O(N·B) memory is used.
+	 */
+	template <typename Weight, typename Vertex, typename Engine>
+	void generate_csr_graph(jsearch::csr_graph<Weight, Vertex> &g, std::size_t const N, unsigned const B, Engine engine)
+	{
+		typedef typename jsearch::csr_graph<Weight, Vertex>::edge_type edge_type;
+
+		Detail::check_preconditions(N, B);
+
+		typename std::conditional<std::is_integral<Weight>::value, std::uniform_int_distribution<Weight>, std::uniform_real_distribution<Weight>>::type weight_dist(1, 500);
+		auto weight_generator(std::bind(weight_dist, engine));
+
+		auto const BODD(B % 2);
+		auto const	END(N / 2 + BODD + N % 2),
+					START(END - B / 2 - BODD);
+		auto const K(END - START); // Edges to higher offsets per vertex.
+		bool const ANTIPODAL(N % 2 == 0 && END - 1 == N / 2); // V + N/2 == V - N/2, so that edge is only stored once.
+
+		std::vector<edge_type> offsets(N + 1);
+		for(std::size_t v(0); v <= N; ++v)
+			offsets[v] = v * B;
+		std::vector<Vertex> targets(N * B);
+		std::vector<Weight> weights(N * B);
+
+		// Draw the weights in the same order as generate_graph.
+		for(std::size_t v(0); v != N; ++v)
+		{
+			for(std::size_t k(0); k != K; ++k)
+			{
+				targets[v * B + k] = (v + START + k) % N;
+				weights[v * B + k] = weight_generator();
+			}
+		}
+
+		// The first weight drawn for an antipodal edge is the one that adjacency_matrix keeps.
+		if(ANTIPODAL)
+			for(std::size_t v(N / 2); v != N; ++v)
+				weights[v * B + K - 1] = weights[(v - N / 2) * B + K - 1];
+
+		for(std::size_t v(0); v != N; ++v)
+		{
+			for(std::size_t k(0); k != K - (ANTIPODAL ? 1 : 0); ++k)
+			{
+				auto const U((v + N - START - k) % N);
+				targets[v * B + K + k] = U;
+				weights[v * B + K + k] = weights[U * B + k];
+			}
+		}
+
+		g = jsearch::csr_graph<Weight, Vertex>(std::move(offsets), std::move(targets), std::move(weights));
+	}
+
+
+	/**
+	 * @brief Generate the graph of generate_csr_graph, but with weights that are a function of SEED and the
+	 * edge alone, on THREADS threads.
+	 *
+	 * Since no weight depends on those drawn before it, the rows are filled in parallel, and the graph is the
+	 * same whatever the number of threads.
+	 */
+	template <typename Weight, typename Vertex>
+	void generate_parallel_csr_graph(jsearch::csr_graph<Weight, Vertex> &g, std::size_t const N, unsigned const B, std::uint64_t const SEED, unsigned const THREADS = std::thread::hardware_concurrency())
+	{
+		typedef typename jsearch::csr_graph<Weight, Vertex>::edge_type edge_type;
+
+		Detail::check_preconditions(N, B);
+
+		std::vector<edge_type> offsets(N + 1);
+		std::vector<Vertex> targets(N * B);
+		std::vector<Weight> weights(N * B);
+		Detail::fill_csr(N, B, SEED, THREADS, offsets.data(), targets.data(), weights.data());
+
+		g = jsearch::csr_graph<Weight, Vertex>(std::move(offsets), std::move(targets), std::move(weights));
+	}
+
+
+	/**
+	 * @brief Write the graph of generate_parallel_csr_graph to PATH, for jsearch::map_csr_graph to use where it
+	 * is.  The rows are filled in place in the mapped file, so the graph needs no memory of its own.
+	 *
+	 * @throws std::system_error if the file cannot be written.
+	 */
+	template <typename Weight, typename Vertex = std::uint32_t>
+	void generate_csr_file(std::string const &PATH, std::size_t const N, unsigned const B, std::uint64_t const SEED, unsigned const THREADS = std::thread::hardware_concurrency())
+	{
+		typedef typename jsearch::csr_graph<Weight, Vertex>::edge_type edge_type;
+
+		Detail::check_preconditions(N, B);
+
+		jsearch::write_csr_graph<Weight, Vertex>(PATH, N, N * B, [&](edge_type *offsets, Vertex *targets, Weight *weights)
+		{
+			Detail::fill_csr(N, B, SEED, THREADS, offsets, targets, weights);
+		});
 	}
 }
@@ -32,7 +32,6 @@
 #include <type_traits>
 #include <cassert>
 #include <cmath>
-#include <boost/graph/graphviz.hpp>
 #include <boost/heap/d_ary_heap.hpp>
 #include <unordered_map>
 #include <fstream>
@@ -69,26 +68,33 @@ using Map = std::unordered_map<Key, Value>;
 int main(int argc, char **argv)
 {
 	init(argc, argv);
-	State const INITIAL(*boost::vertices(G).first);
+	State const INITIAL(0);
 	Problem<Random, Distance, Neighbours, Visit, GoalTest> const PROBLEM(INITIAL);
 	
 	try
 	{
 		auto const T0(chrono::high_resolution_clock::now());
-		auto const SOLUTION(jsearch::recursive_best_first_search<CostFunction, FalseTiePolicy, RBFSPriorityQueue>(PROBLEM));
+		statistics<Random::pathcost> stats;
+		auto const SOLUTION(jsearch::recursive_best_first_search<CostFunction, FalseTiePolicy, RBFSPriorityQueue>(PROBLEM, stats));
 		// auto const SOLUTION(jsearch::best_first_search<PriorityQueue, Comparator, ClosedList, Map>(PROBLEM));
 		auto const ELAPSED(chrono::high_resolution_clock::now() - T0);
 		cout.imbue(locale(""));
 		cout << "Done: " << std::chrono::duration_cast<std::chrono::microseconds>(ELAPSED).count() << " µs\n";
 		cout << backtrace(SOLUTION) << ": " << SOLUTION->path_cost() << "\n";
 
-#ifdef STATISTICS
 		cerr << "**** STATISTICS ****\n";
-		cerr << "pushed: " << stats.pushed << "\n";
-		cerr << "popped: " << stats.popped << "\n";
-		cerr << "decreased: " << stats.decreased << "\n";
-		cerr << "discarded: " << stats.discarded << "\n";
-#endif
+		cerr << "pushed: " << stats.nodes_pushed() << "\n";
+		cerr << "popped: " << stats.nodes_popped() << "\n";
+		cerr << "decreased: " << stats.nodes_decreased() << "\n";
+		cerr << "discarded: " << stats.nodes_discarded() << "\n";
+		cerr << "expanded: " << stats.nodes_expanded() << " (" << stats.expansions_per_second() << "/s)\n";
+		cerr << "peak frontier: " << stats.peak_frontier() << "\n";
+		cerr << "peak closed: " << stats.peak_closed() << "\n";
+		cerr << "actions: " << chrono::duration_cast<chrono::microseconds>(stats.time_in(phase::actions)).count() << " µs\n";
+		cerr << "goal_test: " << chrono::duration_cast<chrono::microseconds>(stats.time_in(phase::goal_test)).count() << " µs\n";
+		cerr << "child: " << chrono::duration_cast<chrono::microseconds>(stats.time_in(phase::child)).count() << " µs\n";
+		cerr << "h: " << chrono::duration_cast<chrono::microseconds>(stats.time_in(phase::h)).count() << " µs\n";
+		cerr << "f-layers: " << stats.f_layers().size() << "\n";
 	}
 	catch (goal_not_found const &ex)
 	{
@@ -131,9 +137,7 @@ void init(int argc, char **argv)
 		exit(EXIT_FAILURE);
 	}
 
-	G = Graph(n);
-	gg::generate_graph(G, boost::num_vertices(G), b, mt19937(s));
-	// weight = new WeightMap(get(boost::edge_weight, G));	
+	gg::generate_parallel_csr_graph(G, n, b, s);
 }
 
 
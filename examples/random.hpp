@@ -17,21 +17,17 @@
 */
 
 #include "problem.hpp"
+#include "csr_graph.hpp"
 
-#include <boost/graph/adjacency_matrix.hpp>
+#include <algorithm>
+#include <limits>
 
 using std::size_t;
-using boost::property;
-using boost::undirectedS;
-using boost::no_property;
-using boost::edge_weight_t;
 
 typedef double cost_t;
-typedef property<edge_weight_t, cost_t> edge_prop;
-typedef boost::adjacency_matrix<undirectedS, no_property, edge_prop> Graph;
-typedef boost::property_map<Graph, edge_weight_t>::type WeightMap;
-typedef typename boost::graph_traits<Graph>::edge_descriptor edge_desc;
-typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_desc;
+typedef jsearch::csr_graph<cost_t> Graph; // Memory is O(n·b), so graphs of millions of vertices fit.
+typedef Graph::edge_type edge_desc;
+typedef Graph::vertex_type vertex_desc;
 
 struct Random
 {
@@ -44,8 +40,7 @@ struct Random
 };
 
 
-Graph G(0);
-WeightMap const weight = boost::get(boost::edge_weight, G);
+Graph G;
 unsigned expanded = 0; // Expanded nodes.
 
 
@@ -60,7 +55,7 @@ public:
 protected:
 	PathCost step_cost(State const &, Action const &ACTION) const
 	{
-		return weight[ACTION];
+		return G.weight(ACTION);
 	}
 };
 
@@ -74,10 +69,41 @@ public:
 	typedef typename Traits::action Action;
 	
 protected:
-	std::vector<Action> actions(State const &STATE) const
+	// A range of edge indices: nothing is copied.
+	Graph::edge_range actions(State const &STATE) const
 	{
-		auto const IT(boost::out_edges(STATE, G));
-		return std::vector<Action>(IT.first, IT.second);
+		return G.out_edges(STATE);
+	}
+};
+
+
+// Neighbours with the operator selection function of partial_expansion_search for Dijkstra, for which
+// the increase in f from a state to a neighbour is the weight of the edge.
+template <typename Traits>
+class NeighboursByWeight : protected Neighbours<Traits>
+{
+public:
+	typedef typename Traits::state State;
+	typedef typename Traits::pathcost PathCost;
+
+protected:
+	using Neighbours<Traits>::actions;
+
+	template <typename Visitor>
+	PathCost actions(State const &STATE, PathCost const &LOW, PathCost const &HIGH, Visitor &&visit) const
+	{
+		auto next(std::numeric_limits<PathCost>::max());
+		for(auto const EDGE : G.out_edges(STATE))
+		{
+			auto const &WEIGHT(G.weight(EDGE));
+			if(WEIGHT < LOW)
+				continue;
+			if(WEIGHT <= HIGH)
+				visit(EDGE);
+			else
+				next = std::min(next, WEIGHT);
+		}
+		return next;
 	}
 };
 
@@ -90,15 +116,18 @@ public:
 	typedef typename Traits::action Action;
 	
 protected:
-	State result(State const &STATE, Action const &ACTION) const
+	State result(State const &, Action const &ACTION) const
 	{
-		auto const 	SOURCE(boost::source(ACTION, G)),
-					TARGET(boost::target(ACTION, G));
-		return SOURCE == STATE ? TARGET : SOURCE;
+		return G.target(ACTION);
 	}
 };
 
 
+// ReversePolicy: the graph is undirected, so the predecessors of STATE are its neighbours.
+template <typename Traits>
+using Edges = jsearch::Symmetric<Traits, Distance, Neighbours, Visit>;
+
+
 template <typename Traits>
 class GoalTest
 {
@@ -106,9 +135,15 @@ public:
 	typedef typename Traits::state State;
 	
 protected:
+	GoalTest() : e_(0) {}
+
+	// The goal is the first state tested after expanded others.  Counting per Problem rather than per
+	// process means each new Problem repeats the same search.
 	bool goal_test(State const &) const
 	{
-		static size_t e_(0);
 		return e_++ == expanded;
 	}
+
+private:
+	mutable size_t e_;
 };
@@ -0,0 +1,471 @@
+/*
+    externalsearch.hpp: External-memory graph search with delayed duplicate detection.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file externalsearch.hpp
+ * @brief Graph search whose frontier and closed list are files, for searches that do not fit in memory.
+ */
+
+#ifndef EXTERNAL_SEARCH_H
+#define EXTERNAL_SEARCH_H
+
+#include "bestfirstsearch.hpp"
+#include "utils/spill_file.hpp"
+#include "utils/state_serializer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jsearch
+{
+	/**
+	 * @brief Where external_search keeps its files and how much it sorts in memory at once.
+	 */
+	class external_options
+	{
+	public:
+		external_options() : directory_("/tmp"), run_length_(1 << 20), buffer_(1 << 16), width_(1) {}
+
+		// Put the files in DIRECTORY, which should be on a disk with room for every state the search reaches.
+		external_options &in_directory(std::string DIRECTORY) { directory_ = std::move(DIRECTORY); return *this; }
+
+		// Sort at most RECORDS records in memory at once, each of which is two states, a path cost and a byte.
+		external_options &records_per_run(std::size_t const RECORDS) { run_length_ = std::max<std::size_t>(1, RECORDS); return *this; }
+
+		// Keep each layer and each file of the closed list in memory until it is more than BYTES.
+		external_options &in_memory_up_to(std::size_t const BYTES) { buffer_ = BYTES; return *this; }
+
+		// Put the nodes with f in [k·WIDTH, (k+1)·WIDTH) in the same layer.
+		external_options &layer_width(double const WIDTH) { width_ = WIDTH; return *this; }
+
+		std::string const &directory() const { return directory_; }
+		std::size_t run_length() const { return run_length_; }
+		std::size_t buffer_size() const { return buffer_; }
+		double width() const { return width_; }
+
+	private:
+		std::string directory_;
+		std::size_t run_length_, buffer_;
+		double width_;
+	};
+
+
+	namespace detail
+	{
+		/**
+		 * @brief The layout of a node in the files of external_search: its state, the state of its parent,
+		 * its path cost and whether it has a parent.  Records are ordered by the bytes of their state.
+		 */
+		template <typename State, typename PathCost>
+		struct external_record
+		{
+			typedef state_serializer<State> Serializer;
+
+			static std::size_t const STATE = Serializer::size;
+			static std::size_t const SIZE = 2 * STATE + sizeof(PathCost) + 1;
+
+			// PARENT is the record of the parent, or nullptr.
+			static void write(unsigned char *out, State const &S, unsigned char const *PARENT, PathCost const &G)
+			{
+				Serializer::write(S, out);
+				if(PARENT)
+					std::memcpy(out + STATE, PARENT, STATE);
+				else
+					std::memset(out + STATE, 0, STATE);
+				std::memcpy(out + 2 * STATE, &G, sizeof G);
+				out[SIZE - 1] = PARENT != nullptr;
+			}
+
+			static State state(unsigned char const *RECORD) { return Serializer::read(RECORD); }
+			static bool has_parent(unsigned char const *RECORD) { return RECORD[SIZE - 1] != 0; }
+
+			// The parent's state as the first bytes of a pseudo-record, for compare().
+			static unsigned char const *parent(unsigned char const *RECORD) { return RECORD + STATE; }
+
+			static PathCost g(unsigned char const *RECORD)
+			{
+				PathCost result;
+				std::memcpy(&result, RECORD + 2 * STATE, sizeof result);
+				return result;
+			}
+
+			static int compare(unsigned char const *A, unsigned char const *B) { return std::memcmp(A, B, STATE); }
+
+			// By state, then by path cost, so that the first of equal states is the best.
+			static bool before(unsigned char const *A, unsigned char const *B)
+			{
+				int const ORDER(compare(A, B));
+				return ORDER != 0 ? ORDER < 0 : g(A) < g(B);
+			}
+		};
+
+
+		/**
+		 * @brief The unread part of a sorted run, ordered so that a std::priority_queue gives the first
+		 * record of all the runs.
+		 */
+		template <class Record>
+		struct run_cursor
+		{
+			run_cursor(unsigned char const *FIRST, unsigned char const *LAST) : first(FIRST), last(LAST) {}
+
+			bool operator<(run_cursor const &OTHER) const { return Record::before(OTHER.first, first); }
+
+			unsigned char const *first, *last;
+		};
+
+
+		/**
+		 * @brief The closed list of external_search: sorted files of records without duplicates, with the
+		 * newest and smallest last.  A new file is merged with the one before it while that one is no more than
+		 * twice its size, so there are O(log n) files and each record is rewritten O(log n) times.  Where a
+		 * state has a record in more than one file, the newest, which has the lowest g, is the right one.
+		 */
+		template <class Record>
+		class closed_levels
+		{
+			struct level
+			{
+				level(std::unique_ptr<spill_file> FILE) : file(std::move(FILE)), records(new mapped_file(*file)) {}
+
+				std::unique_ptr<spill_file> file;
+				std::unique_ptr<mapped_file> records;
+			};
+
+			typedef std::vector<level> Levels;
+
+		public:
+			/**
+			 * @brief Looks up records for keys that are given in increasing order, by galloping forward through
+			 * each file, so that dense lookups read the files sequentially and sparse ones binary search them.
+			 * The closed_levels must not change while a probe is used.
+			 */
+			class probe
+			{
+			public:
+				explicit probe(closed_levels const &CLOSED) : levels(CLOSED.levels), positions(levels.size(), 0) {}
+
+				// @return The newest record with the state of KEY, or nullptr.
+				unsigned char const *find(unsigned char const *KEY)
+				{
+					for(std::size_t i(levels.size()); i-- != 0; )
+					{
+						if(auto const RECORD = gallop(*levels[i].records, positions[i], KEY))
+							return RECORD;
+					}
+					return nullptr;
+				}
+
+			private:
+				// Every record before position is before KEY.
+				static unsigned char const *gallop(mapped_file const &LEVEL, std::size_t &position, unsigned char const *KEY)
+				{
+					std::size_t const N(LEVEL.size() / Record::SIZE);
+					auto const AT = [&](std::size_t const I) { return LEVEL.data() + I * Record::SIZE; };
+					std::size_t first(position), last(position), step(1);
+
+					for(; last < N && Record::compare(AT(last), KEY) < 0; step *= 2)
+					{
+						first = last + 1;
+						last += step;
+					}
+					last = std::min(last, N);
+					while(first != last)
+					{
+						std::size_t const MIDDLE(first + (last - first) / 2);
+						if(Record::compare(AT(MIDDLE), KEY) < 0)
+							first = MIDDLE + 1;
+						else
+							last = MIDDLE;
+					}
+
+					position = first;
+					return first != N && Record::compare(AT(first), KEY) == 0 ? AT(first) : nullptr;
+				}
+
+				Levels const &levels;
+				std::vector<std::size_t> positions;
+			};
+
+			closed_levels(std::string const &DIRECTORY, std::size_t const BUFFER) : directory(DIRECTORY), BUFFER(BUFFER) {}
+
+			// Add the records in FILE, which are sorted and unique.
+			void add(std::unique_ptr<spill_file> file)
+			{
+				if(file->size() == 0)
+					return;
+				levels.emplace_back(std::move(file));
+				while(levels.size() > 1 && levels[levels.size() - 2].file->size() <= 2 * levels.back().file->size())
+					merge();
+			}
+
+			unsigned char const *find(unsigned char const *KEY) const { return probe(*this).find(KEY); }
+
+			// The number of records, which counts a state more than once while it is in more than one file.
+			std::size_t size() const
+			{
+				std::size_t result(0);
+				for(auto const &LEVEL : levels)
+					result += LEVEL.file->size() / Record::SIZE;
+				return result;
+			}
+
+		private:
+			// Merge the last file into the one before it, keeping the newer of equal records.
+			void merge()
+			{
+				std::size_t const R(Record::SIZE);
+				std::unique_ptr<spill_file> merged(new spill_file(directory, BUFFER));
+				{
+					level const NEWER(std::move(levels.back()));
+					levels.pop_back();
+					level const OLDER(std::move(levels.back()));
+					levels.pop_back();
+
+					unsigned char const *older(OLDER.records->data()), *newer(NEWER.records->data());
+					unsigned char const *const OLDER_END(older + OLDER.records->size()), *const NEWER_END(newer + NEWER.records->size());
+					while(older != OLDER_END && newer != NEWER_END)
+					{
+						int const ORDER(Record::compare(older, newer));
+						if(ORDER < 0)
+						{
+							merged->write(older, R);
+							older += R;
+						}
+						else
+						{
+							if(ORDER == 0)
+								older += R;
+							merged->write(newer, R);
+							newer += R;
+						}
+					}
+					merged->write(older, OLDER_END - older);
+					merged->write(newer, NEWER_END - newer);
+				}
+				levels.emplace_back(std::move(merged));
+			}
+
+			std::string const directory;
+			std::size_t const BUFFER;
+			Levels levels;
+		};
+	}
+
+
+	/*********************************************
+	 *	External search	 	 	 	 	 	 	 *
+	 *********************************************/
+	/**
+	 * @brief Graph search with delayed duplicate detection over f-layers, after Edelkamp, Jabbar and
+	 * Schrödl's External A* (2004).
+	 *
+	 * Nothing grows in memory with the search.  Each layer of the frontier, the nodes with f in one interval
+	 * of options.width(), is a file that children are only appended to.  The layer with the lowest f is
+	 * sorted in runs of options.run_length() records, which are merged without duplicates and then checked
+	 * against the closed list, which is a few sorted files (see closed_levels).  Whatever is not in the closed
+	 * list, or has a lower g there, is expanded and added to it.  Every file is written sequentially and read
+	 * through mmap, sequentially or by galloping search, and a file that is no more than
+	 * options.buffer_size() stays in memory.
+	 *
+	 * A layer is searched again while its own children add to it, so nodes in the same layer need not be
+	 * expanded in order of f: with integer costs and a width of 1 each layer is one f and nothing is expanded
+	 * twice; with a wider layer a state may be expanded again with a lower g.  Either way, the search stops
+	 * after the layer that has a goal, with the cheapest goal, if the heuristic of CostFunction is consistent.
+	 *
+	 * The Problem is unchanged, except that the state needs state_serializer.  The nodes made for each
+	 * expansion are not kept by the search, so the CreatePolicy should free them, as DefaultNodeCreator does,
+	 * rather than keep them until the search ends.
+	 *
+	 * The Observer's sizes() are the records in the frontier's files, before duplicates are removed, and the
+	 * states in the closed list.
+	 *
+	 * @return The path cost of the goal, whose path is written from the goal back to the initial state.
+	 *
+	 * @throws goal_not_found
+	 * @throws std::system_error if a file cannot be created, written or mapped.
+	 */
+	template <template <typename Traits> class CostFunction,
+			typename Traits,
+			template <typename Traits_> class StepCostPolicy,
+			template <typename Traits_> class ActionsPolicy,
+			template <typename Traits_> class ResultPolicy,
+			template <typename Traits_> class GoalTestPolicy,
+			template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy,
+				template <typename Traits__> class ResultPolicy,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy,
+			typename Output,
+			typename Observer = null_observer>
+	typename Traits::pathcost external_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, external_options const &OPTIONS, Output path, Observer &&observer = Observer())
+	{
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+		typedef typename Traits::action Action;
+		typedef typename Traits::pathcost PathCost;
+		typedef detail::external_record<State, PathCost> Record;
+		typedef detail::run_cursor<Record> Cursor;
+
+		detail::release_guard<Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy>> const RELEASE(PROBLEM);
+		detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+		CostFunction<Traits> const COST;
+		std::size_t const R(Record::SIZE);
+		std::map<long long, std::unique_ptr<spill_file>> layers;
+		detail::closed_levels<Record> closed(OPTIONS.directory(), OPTIONS.buffer_size());
+		std::size_t open(0);
+		std::vector<unsigned char> buffer(R), goal; // goal is the record of the best goal so far, if any.
+		std::vector<unsigned char const *> order;
+		std::vector<unsigned char> sorted;
+		std::vector<std::pair<std::size_t, std::size_t>> bounds; // The first and last record of each run.
+
+		auto const APPEND = [&](Node const &NODE, unsigned char const *PARENT)
+		{
+			auto &layer(layers[static_cast<long long>(std::floor(double(COST.f(NODE)) / OPTIONS.width()))]);
+			if(!layer)
+				layer.reset(new spill_file(OPTIONS.directory(), OPTIONS.buffer_size()));
+			Record::write(buffer.data(), NODE->state(), PARENT, NODE->path_cost());
+			layer->write(buffer.data(), R);
+			++open;
+		};
+
+		APPEND(PROBLEM.create(PROBLEM.initial, Node(), Action(), 0), nullptr);
+
+		// Nothing in a later layer can lead to a goal cheaper than one already found.
+		while(!layers.empty() && !(!goal.empty() && double(Record::g(goal.data())) <= double(layers.begin()->first) * OPTIONS.width()))
+		{
+			std::unique_ptr<spill_file> layer(std::move(layers.begin()->second));
+			layers.erase(layers.begin());
+
+			// Sort the layer in runs, which only go to a file if there is more than one.
+			std::size_t const RUN(OPTIONS.run_length());
+			std::unique_ptr<spill_file> runs;
+			bounds.clear();
+			{
+				mapped_file const LAYER(*layer);
+				std::size_t const N(LAYER.size() / R);
+				open -= N;
+				for(std::size_t first(0); first < N; first += RUN)
+				{
+					std::size_t const LAST(std::min(N, first + RUN));
+					order.clear();
+					for(std::size_t i(first); i != LAST; ++i)
+						order.push_back(LAYER.data() + i * R);
+					std::sort(std::begin(order), std::end(order), &Record::before);
+
+					sorted.clear();
+					for(auto const RECORD : order)
+						sorted.insert(std::end(sorted), RECORD, RECORD + R);
+					if(N > RUN)
+					{
+						if(!runs)
+							runs.reset(new spill_file(OPTIONS.directory()));
+						runs->write(sorted.data(), sorted.size());
+					}
+					bounds.emplace_back(first, LAST);
+				}
+			}
+			layer.reset();
+
+			// Merge the runs without duplicates, then leave out what was already closed with no higher g.
+			std::unique_ptr<spill_file> survivors(new spill_file(OPTIONS.directory(), OPTIONS.buffer_size()));
+			{
+				std::unique_ptr<mapped_file> const RUNS(runs ? new mapped_file(*runs) : nullptr);
+				unsigned char const *const BASE(RUNS ? RUNS->data() : sorted.data());
+				std::priority_queue<Cursor> merge;
+				for(auto const &BOUND : bounds)
+					merge.push(Cursor(BASE + BOUND.first * R, BASE + BOUND.second * R));
+
+				typename detail::closed_levels<Record>::probe known(closed);
+				unsigned char const *previous(nullptr);
+				while(!merge.empty())
+				{
+					Cursor run(merge.top());
+					merge.pop();
+					unsigned char const *const RECORD(run.first);
+					run.first += R;
+					if(run.first != run.last)
+						merge.push(run);
+					observer.popped();
+
+					// A duplicate in this layer, with no lower g.
+					if(previous && Record::compare(previous, RECORD) == 0)
+					{
+						observer.discarded();
+						continue;
+					}
+					previous = RECORD;
+
+					// A state is only closed again if it was reached more cheaply.
+					auto const KNOWN(known.find(RECORD));
+					if(KNOWN && !(Record::g(RECORD) < Record::g(KNOWN)))
+					{
+						observer.discarded();
+						continue;
+					}
+					survivors->write(RECORD, R);
+
+					State const STATE(Record::state(RECORD));
+					if(observer.measure(phase::goal_test, [&]{ return PROBLEM.goal_test(STATE); }))
+					{
+						if(goal.empty() || Record::g(RECORD) < Record::g(goal.data()))
+							goal.assign(RECORD, RECORD + R);
+						continue;
+					}
+
+					Node const NODE(PROBLEM.create(STATE, Node(), Action(), Record::g(RECORD)));
+					observer.expanded(NODE, COST);
+					detail::for_each_action(PROBLEM, STATE, [&](Action const &ACTION)
+					{
+						auto const SUCCESSOR(observer.measure(phase::child, [&]{ return PROBLEM.result(STATE, ACTION); }));
+						APPEND(observer.measure(phase::child, [&]{ return PROBLEM.child(NODE, ACTION, SUCCESSOR); }), RECORD);
+						observer.pushed();
+					}, observer);
+				}
+			}
+			closed.add(std::move(survivors));
+			observer.sizes(open, closed.size());
+		}
+
+		if(goal.empty())
+			throw goal_not_found();
+
+		// Every ancestor of the goal was expanded, so it is in the closed list.
+		unsigned char const *record(goal.data());
+		*path++ = Record::state(record);
+		while(Record::has_parent(record))
+		{
+			record = closed.find(Record::parent(record));
+			*path++ = Record::state(record);
+		}
+
+		return Record::g(goal.data());
+	}
+}
+
+#endif // EXTERNAL_SEARCH_H
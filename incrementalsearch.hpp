@@ -0,0 +1,340 @@
+/*
+    incrementalsearch.hpp: Lifelong Planning A* (LPA*), which repairs its search when step costs change.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file incrementalsearch.hpp
+ * @brief A search between two fixed states that is replanned, rather than started again, after step costs change.
+ *
+ *   incremental_search<Problem, AStar, PriorityQueue, state_table> planner(PROBLEM);
+ *   planner.search(path);
+ *   // Change the cost of the edge from U to V in the Problem, then:
+ *   planner.edge_changed(U, V);
+ *   planner.search(path);
+ */
+
+#ifndef INCREMENTAL_SEARCH_H
+#define INCREMENTAL_SEARCH_H
+
+#include "bestfirstsearch.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+namespace jsearch
+{
+	namespace detail
+	{
+		/**
+		 * @brief What incremental_search knows about a state: its g, the rhs that one step from its
+		 * predecessors would give it, and its handle on the frontier if they differ.
+		 */
+		template <typename Handle, typename PathCost>
+		struct lpa_entry
+		{
+			lpa_entry() : g(std::numeric_limits<PathCost>::max()), rhs(std::numeric_limits<PathCost>::max()), handle(), queued(false) {}
+
+			PathCost g, rhs;
+			Handle handle;
+			bool queued;
+		};
+
+
+		/**
+		 * @brief A state on the frontier of incremental_search with its key: f of the lesser of g and rhs, then
+		 * the lesser itself.
+		 */
+		template <typename State, typename Cost, typename PathCost>
+		struct lpa_item
+		{
+			lpa_item() : f(), g(), state() {}
+			lpa_item(Cost const &F, PathCost const &G, State const &STATE) : f(F), g(G), state(STATE) {}
+
+			Cost f;
+			PathCost g;
+			State state;
+		};
+
+
+		template <typename State, typename Cost, typename PathCost>
+		inline bool operator<(lpa_item<State, Cost, PathCost> const &A, lpa_item<State, Cost, PathCost> const &B)
+		{
+			return A.f < B.f || (!(B.f < A.f) && A.g < B.g);
+		}
+
+
+		struct lpa_order
+		{
+			lpa_order() {}
+
+			template <typename Item>
+			bool operator()(Item const &A, Item const &B) const
+			{
+				return B < A;
+			}
+		};
+	}
+
+
+	/************************************
+	 *	Lifelong Planning A* (LPA*)	 	*
+	 ************************************/
+	/**
+	 * @brief Search from PROBLEM.initial to PROBLEM.goal that keeps its g values, rhs values and frontier
+	 * between calls, after Koenig, Likhachev and Furcy (2004).
+	 *
+	 * The first call of search() is an A* search.  After that, edge_changed() is called for each step whose
+	 * cost has changed in the Problem, and the next search() repairs only the states whose g the changes
+	 * affect.  A small change therefore replans in a fraction of the time of a new search.
+	 *
+	 * Problem is a BidirectionalProblem, since the rhs of a state is the least g + step cost over its
+	 * predecessors.  For Symmetric, a changed cost must be changed in both directions, and edge_changed()
+	 * called for both.  Step costs must be positive, and if CostFunction has a heuristic it must be
+	 * consistent.  The GoalTestPolicy is not used.  PriorityQueue must be mutable and support erase(), as
+	 * the mutable heaps of Boost.Heap do, and Table must be like state_table.
+	 *
+	 * Like the Problem, an incremental_search must not be shared between threads.
+	 */
+	template <class Problem,
+			template <typename Traits> class CostFunction,
+			template <typename T, typename Comparator> class PriorityQueue,
+			template <typename Key, typename Value> class Table>
+	class incremental_search
+	{
+		typedef typename Problem::traits Traits;
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+		typedef typename Traits::action Action;
+		typedef typename Traits::pathcost PathCost;
+		typedef typename CostFunction<Traits>::Cost Cost;
+		typedef detail::lpa_item<State, Cost, PathCost> Item;
+		typedef PriorityQueue<Item, detail::lpa_order> Frontier;
+		typedef detail::lpa_entry<typename Frontier::handle_type, PathCost> Entry;
+
+	public:
+		explicit incremental_search(Problem const &PROBLEM) : problem(PROBLEM), started(false) {}
+
+		/**
+		 * @brief Find the cheapest path to PROBLEM.goal with the step costs as they are now.
+		 *
+		 * @return The path cost of the goal, whose path is written from the goal back to the initial state.
+		 *
+		 * @throws goal_not_found
+		 */
+		template <typename Output, typename Observer = null_observer>
+		PathCost search(Output path, Observer &&observer = Observer())
+		{
+			detail::release_guard<Problem> const RELEASE(problem);
+			detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+
+			if(!started)
+			{
+				table.insert(problem.initial).first->rhs = 0;
+				settle(problem.initial, observer);
+				started = true;
+			}
+
+			repair(observer);
+
+			auto const *const GOAL(table.find(problem.goal));
+			if(!GOAL || GOAL->g == INFINITE)
+				throw goal_not_found();
+
+			// Each state on the path is one step from a predecessor whose g accounts for it.
+			PathCost const COST(GOAL->g);
+			State state(problem.goal);
+			*path++ = state;
+			while(!(state == problem.initial))
+			{
+				State best(state);
+				PathCost least(INFINITE);
+				problem.predecessors(state, [&](State const &PREDECESSOR, PathCost const &STEP)
+				{
+					auto const *const KNOWN(table.find(PREDECESSOR));
+					if(KNOWN && KNOWN->g != INFINITE && KNOWN->g + STEP < least)
+					{
+						least = KNOWN->g + STEP;
+						best = PREDECESSOR;
+					}
+				});
+				state = best;
+				*path++ = state;
+			}
+
+			return COST;
+		}
+
+		/**
+		 * @brief Tell the search that the cost of the step from FROM to TO has changed in the Problem, or that
+		 * the step has appeared or gone.
+		 *
+		 * Nothing is searched until the next search().  A change to a step from a state that the search has
+		 * not reached costs one lookup.
+		 */
+		void edge_changed(State const &FROM, State const &TO)
+		{
+			if(!started || TO == problem.initial)
+				return;
+
+			auto const *const SOURCE(table.find(FROM));
+			if(!SOURCE || SOURCE->g == INFINITE)
+				return;
+
+			null_observer none;
+			recompute(TO);
+			settle(TO, none);
+		}
+
+		// The number of states on the frontier, and of those that the search has ever reached.
+		std::size_t frontier_size() const { return frontier.size(); }
+		std::size_t states() const { return table.size(); }
+
+	private:
+		static constexpr PathCost INFINITE = std::numeric_limits<PathCost>::max();
+
+		// The key of STATE on the frontier, from an entry for it.
+		Item key(State const &STATE, Entry const &ENTRY) const
+		{
+			PathCost const G(ENTRY.rhs < ENTRY.g ? ENTRY.rhs : ENTRY.g);
+			return G == INFINITE ? Item(std::numeric_limits<Cost>::max(), G, STATE) : Item(COST.f(STATE, G), G, STATE);
+		}
+
+		// Put STATE on the frontier, or move or take it off, according to whether its g and rhs differ.
+		template <class Observer>
+		void settle(State const &STATE, Observer &observer)
+		{
+			Entry &entry(*table.find(STATE));
+			if(entry.g != entry.rhs)
+			{
+				Item const ITEM(key(STATE, entry));
+				if(entry.queued)
+				{
+					bool const DECREASED(ITEM < *entry.handle);
+					frontier.update(entry.handle, ITEM);
+					if(DECREASED)
+						observer.decreased();
+				}
+				else
+				{
+					entry.handle = frontier.push(ITEM);
+					entry.queued = true;
+					observer.pushed();
+				}
+			}
+			else if(entry.queued)
+			{
+				frontier.erase(entry.handle);
+				entry.queued = false;
+			}
+		}
+
+		// Set the rhs of STATE to the least g + step cost over its predecessors.
+		void recompute(State const &STATE)
+		{
+			table.insert(STATE);
+			PathCost least(INFINITE);
+			problem.predecessors(STATE, [&](State const &PREDECESSOR, PathCost const &STEP)
+			{
+				auto const *const KNOWN(table.find(PREDECESSOR));
+				if(KNOWN && KNOWN->g != INFINITE && KNOWN->g + STEP < least)
+					least = KNOWN->g + STEP;
+			});
+			table.find(STATE)->rhs = least;
+		}
+
+		// Expand states in order of their keys until the goal is consistent and no key is below its key.
+		template <class Observer>
+		void repair(Observer &observer)
+		{
+			while(!frontier.empty())
+			{
+				auto const *const GOAL(table.find(problem.goal));
+				if(!(frontier.top() < (GOAL ? key(problem.goal, *GOAL) : Item(std::numeric_limits<Cost>::max(), INFINITE, problem.goal))) && (!GOAL || GOAL->g == GOAL->rhs))
+					break;
+
+				State const STATE(detail::pop(frontier).state);
+				observer.popped();
+				Entry &expanding(*table.find(STATE));
+				expanding.queued = false;
+
+				if(expanding.rhs < expanding.g)
+				{
+					// Overconsistent: the state is settled at its rhs, which may lower that of its successors.
+					PathCost const G(expanding.g = expanding.rhs);
+					observer.expanded(problem.create(STATE, Node(), Action(), G), COST);
+					successors(STATE, [&](State const &SUCCESSOR, PathCost const &STEP)
+					{
+						if(SUCCESSOR == problem.initial)
+							return;
+						Entry &successor(*table.insert(SUCCESSOR).first);
+						if(G + STEP < successor.rhs)
+						{
+							successor.rhs = G + STEP;
+							settle(SUCCESSOR, observer);
+						}
+						else
+							observer.discarded();
+					}, observer);
+				}
+				else
+				{
+					// Underconsistent: the state's g is forgotten, and so is the rhs of each successor that came from it.
+					PathCost const OLD(expanding.g);
+					expanding.g = INFINITE;
+					observer.expanded(problem.create(STATE, Node(), Action(), OLD), COST);
+					settle(STATE, observer);
+					successors(STATE, [&](State const &SUCCESSOR, PathCost const &STEP)
+					{
+						if(SUCCESSOR == problem.initial)
+							return;
+						auto const *const KNOWN(table.find(SUCCESSOR));
+						if(KNOWN && KNOWN->rhs == OLD + STEP)
+						{
+							recompute(SUCCESSOR);
+							settle(SUCCESSOR, observer);
+						}
+					}, observer);
+				}
+
+				observer.sizes(frontier.size(), table.size() - frontier.size());
+			}
+		}
+
+		// Call visit(SUCCESSOR, STEP) for each step from STATE.
+		template <typename Visitor, class Observer>
+		void successors(State const &STATE, Visitor &&visit, Observer &observer) const
+		{
+			detail::for_each_action(problem, STATE, [&](Action const &ACTION)
+			{
+				visit(observer.measure(phase::child, [&]{ return problem.result(STATE, ACTION); }), problem.step_cost(STATE, ACTION));
+			}, observer);
+		}
+
+		Problem const &problem;
+		CostFunction<Traits> const COST;
+		Frontier frontier;
+		Table<State, Entry> table;
+		bool started;
+	};
+
+
+	template <class Problem, template <typename Traits> class CostFunction, template <typename T, typename Comparator> class PriorityQueue, template <typename Key, typename Value> class Table>
+	constexpr typename Problem::traits::pathcost incremental_search<Problem, CostFunction, PriorityQueue, Table>::INFINITE;
+}
+
+#endif // INCREMENTAL_SEARCH_H
@@ -0,0 +1,190 @@
+/*
+    iterativedeepeningsearch.hpp: Iterative-deepening A* (IDA*).
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file iterativedeepeningsearch.hpp
+ * @brief Depth-first search with an increasing bound on f, which creates no nodes.
+ */
+
+#ifndef ITERATIVE_DEEPENING_SEARCH_H
+#define ITERATIVE_DEEPENING_SEARCH_H
+
+#include "bestfirstsearch.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jsearch
+{
+	namespace detail
+	{
+		/**
+		 * @brief A state on the path of iterative_deepening_search, and where it is up to in its actions.
+		 *
+		 * The actions of every frame are stored in one buffer, those of this frame from first to last.
+		 */
+		template <typename State, typename PathCost>
+		struct ida_frame
+		{
+			ida_frame(State STATE, PathCost const &G) : state(std::move(STATE)), g(G), first(0), next(0), last(0), expanded(false) {}
+
+			State state;
+			PathCost g;
+			std::size_t first, next, last;
+			bool expanded;
+		};
+
+
+		/**
+		 * @brief Let an Observer evaluate frames as if they were nodes.
+		 */
+		template <class CostFunction>
+		class frame_evaluator
+		{
+		public:
+			frame_evaluator(CostFunction const &COST) : cost(COST) {}
+
+			template <typename Frame>
+			typename CostFunction::Cost f(Frame const &FRAME) const { return cost.f(FRAME.state, FRAME.g); }
+
+		private:
+			CostFunction const &cost;
+		};
+	}
+
+
+	/**********************************
+	 *	Iterative-deepening A* (IDA*)  *
+	 **********************************/
+	/**
+	 * @brief Iterative-deepening A* from Korf (1985).
+	 *
+	 * Each iteration is a depth-first search that does not go past states whose f exceeds the threshold, and
+	 * the next threshold is the lowest f that exceeded it.  The path is an explicit stack of frames and all of
+	 * their actions share one buffer, both of which are reused from one iteration to the next, so after the
+	 * deepest iteration so far the search allocates only what the Problem's policies do.  No nodes are
+	 * created: CostFunction must provide f(State, PathCost), as AStar, Greedy and Dijkstra do.
+	 *
+	 * A child with the same state as its grandparent is not generated, which removes the most common
+	 * cycles in domains with reversible actions.  The search does not detect any other duplicates.
+	 *
+	 * The Observer is told about every iteration by iteration(threshold), and sizes() reports the depth of
+	 * the path.
+	 *
+	 * @return The path cost of the goal, whose path is written from the goal back to the initial state.
+	 *
+	 * @throws goal_not_found
+	 */
+	template <template <typename Traits> class CostFunction,
+		typename Traits,
+		template <typename Traits_> class StepCostPolicy,
+		template <typename Traits_> class ActionsPolicy,
+		template <typename Traits_> class ResultPolicy,
+		template <typename Traits_> class GoalTestPolicy,
+		template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+		template <typename Traits_,
+			template <typename Traits__> class StepCostPolicy,
+			template <typename Traits__> class ResultPolicy,
+			template <typename Traits__> class CreatePolicy>
+			class ChildPolicy = DefaultChildPolicy,
+		typename Output,
+		typename Observer = null_observer>
+	typename Traits::pathcost iterative_deepening_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Output path, Observer &&observer = Observer())
+	{
+		typedef typename Traits::state State;
+		typedef typename Traits::action Action;
+		typedef typename Traits::pathcost PathCost;
+		typedef typename Traits::cost Cost;
+		typedef detail::ida_frame<State, PathCost> Frame;
+
+		constexpr auto const INF(std::numeric_limits<Cost>::max());
+		detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+		CostFunction<Traits> const COST;
+		detail::frame_evaluator<CostFunction<Traits>> const EVALUATOR(COST);
+		std::vector<Frame> frames;
+		std::vector<Action> actions;
+
+		for(Cost threshold(COST.f(PROBLEM.initial, 0)); threshold != INF; )
+		{
+			observer.iteration(threshold);
+			Cost next(INF);
+			frames.emplace_back(PROBLEM.initial, 0);
+
+			while(!frames.empty())
+			{
+				Frame &top(frames.back());
+
+				if(!top.expanded)
+				{
+					observer.popped();
+					if(observer.measure(phase::goal_test, [&]{ return PROBLEM.goal_test(top.state); }))
+					{
+						auto const RESULT(top.g);
+						for(auto frame(frames.rbegin()); frame != frames.rend(); ++frame)
+							*path++ = frame->state;
+						return RESULT;
+					}
+
+					observer.expanded(top, EVALUATOR);
+					top.expanded = true;
+					top.first = top.next = actions.size();
+					detail::for_each_action(PROBLEM, top.state, [&](Action const &ACTION)
+					{
+						actions.push_back(ACTION);
+					}, observer);
+					top.last = actions.size();
+					observer.sizes(frames.size(), 0);
+				}
+
+				if(top.next == top.last)
+				{
+					actions.resize(top.first);
+					frames.pop_back();
+					continue;
+				}
+
+				// The buffer does not change until the child is expanded.
+				auto const &ACTION(actions[top.next++]);
+				auto child(observer.measure(phase::child, [&]{ return PROBLEM.result(top.state, ACTION); }));
+				if(frames.size() > 1 && child == frames[frames.size() - 2].state)
+					continue;
+
+				PathCost const G(top.g + PROBLEM.step_cost(top.state, ACTION));
+				auto const F(COST.f(child, G));
+				if(F > threshold)
+				{
+					next = std::min(next, F);
+					continue;
+				}
+
+				frames.emplace_back(std::move(child), G); // Invalidates top.
+				observer.pushed();
+			}
+
+			threshold = next;
+		}
+
+		throw goal_not_found();
+	}
+}
+
+#endif // ITERATIVE_DEEPENING_SEARCH_H
@@ -0,0 +1,265 @@
+/*
+    memoryboundedsearch.hpp: Simplified memory-bounded A* (SMA*).
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file memoryboundedsearch.hpp
+ * @brief Tree search that keeps at most a given number of nodes in memory.
+ */
+
+#ifndef MEMORY_BOUNDED_SEARCH_H
+#define MEMORY_BOUNDED_SEARCH_H
+
+#include "bestfirstsearch.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <set>
+#include <type_traits>
+#include <vector>
+
+namespace jsearch
+{
+	namespace detail
+	{
+		/**
+		 * @brief A node of the search tree that SMA* keeps in memory.
+		 *
+		 * Either all of the children of an entry are in memory, or none of them are.  So the F of an entry
+		 * with children is the lowest F of its children, and the F of a leaf is the lowest F of the children
+		 * that were forgotten, if it was ever expanded.
+		 */
+		template <typename Node, typename Cost>
+		struct sma_entry
+		{
+			sma_entry(Node const &NODE, Cost const &F, sma_entry *PARENT, std::size_t const DEPTH, std::size_t const ID) : node(NODE), f(F), parent(PARENT), depth(DEPTH), id(ID) {}
+
+			bool leaf() const { return children.empty(); }
+
+			// Is the whole of this subtree just this entry and its children?
+			bool frontier_parent() const
+			{
+				return !leaf() && std::all_of(std::begin(children), std::end(children), [](std::unique_ptr<sma_entry> const &CHILD){ return CHILD->leaf(); });
+			}
+
+			Node node;
+			Cost f; // The backed-up f, which never decreases.
+			sma_entry *parent;
+			std::size_t depth;
+			std::size_t id; // Order of creation, so that both orderings below are total.
+			std::vector<std::unique_ptr<sma_entry>> children;
+		};
+
+
+		/**
+		 * @brief Order the leaves that SMA* can expand from best to worst: lowest F, then TiePolicy, then deepest.
+		 */
+		template <typename Traits, template <typename Traits_> class TiePolicy>
+		class sma_open_order : protected TiePolicy<Traits>
+		{
+			using TiePolicy<Traits>::split;
+
+		public:
+			typedef sma_entry<typename Traits::node, typename Traits::cost> Entry;
+
+			bool operator()(Entry const *A, Entry const *B) const
+			{
+				if(A->f != B->f)
+					return A->f < B->f;
+				// split(A, B) is true when A is the worse of the two.
+				if(split(B->node, A->node))
+					return true;
+				if(split(A->node, B->node))
+					return false;
+				if(A->depth != B->depth)
+					return A->depth > B->depth;
+				return A->id < B->id;
+			}
+		};
+
+
+		/**
+		 * @brief Order the entries whose children can be forgotten from worst to best: highest F, then shallowest.
+		 */
+		template <typename Entry>
+		struct sma_prune_order
+		{
+			bool operator()(Entry const *A, Entry const *B) const
+			{
+				if(A->f != B->f)
+					return A->f > B->f;
+				if(A->depth != B->depth)
+					return A->depth < B->depth;
+				return A->id < B->id;
+			}
+		};
+	}
+
+
+	/******************************************
+	 *	Simplified memory-bounded A* (SMA*)  *
+	 ******************************************/
+	/**
+	 * @brief Tree search with at most LIMIT nodes in memory, after Russell's SMA* (1992).
+	 *
+	 * The search expands the leaf with the lowest F, where a child's F is the greater of its parent's F and
+	 * CostFunction::f(child), exactly as A* would while there is room.  All of the children of a node are
+	 * generated at once.  When that puts more than LIMIT nodes in memory, the search forgets the worst group
+	 * of leaves that are all the children of one node, so that node becomes a leaf again, and remembers their
+	 * lowest F as its own, to be regenerated only if nothing else is better.  If the only group that is left
+	 * to forget is the one just generated, a solution below that node does not fit in LIMIT, so its F becomes
+	 * infinite.
+	 *
+	 * With an admissible heuristic, the result is optimal among the solutions whose path fits in memory with
+	 * its siblings.  A larger LIMIT means fewer re-expansions, up to the number of nodes that A* would keep.
+	 * Memory is counted in nodes, and LIMIT is exceeded by at most one expansion while the search is pruning.
+	 * A LIMIT of 0 is taken to be 1, since the root is always in memory.
+	 * A CreatePolicy that owns its nodes, like ArenaNodeCreator, only destroys forgotten nodes on release().
+	 *
+	 * The Observer is told about each node that is forgotten by pruned(), and sizes() reports the number of
+	 * leaves and the number of nodes in memory.
+	 *
+	 * @return A goal Node from which the path can be reconstructed.
+	 *
+	 * @throws goal_not_found
+	 */
+	template <template <typename Traits> class CostFunction,
+		template <typename Traits> class TiePolicy,
+		typename Traits,
+		template <typename Traits_> class StepCostPolicy,
+		template <typename Traits_> class ActionsPolicy,
+		template <typename Traits_> class ResultPolicy,
+		template <typename Traits_> class GoalTestPolicy,
+		template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+		template <typename Traits_,
+			template <typename Traits__> class StepCostPolicy,
+			template <typename Traits__> class ResultPolicy,
+			template <typename Traits__> class CreatePolicy>
+			class ChildPolicy = DefaultChildPolicy,
+		typename Observer = null_observer>
+	typename Traits::node memory_bounded_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, std::size_t const LIMIT, Observer &&observer = Observer())
+	{
+		typedef typename Traits::node Node;
+		typedef typename Traits::action Action;
+		typedef typename Traits::cost Cost;
+		typedef detail::sma_entry<Node, Cost> Entry;
+
+		constexpr auto const INF(std::numeric_limits<Cost>::max());
+		detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+		CostFunction<Traits> const COST;
+		std::set<Entry *, detail::sma_open_order<Traits, TiePolicy>> open; // The leaves.
+		std::set<Entry *, detail::sma_prune_order<Entry>> prunable; // The entries whose children are all leaves.
+		std::size_t ids(0), memory(1);
+		std::size_t const BOUND(std::max(LIMIT, std::size_t(1))); // The root is always in memory.
+
+		auto const INITIAL(PROBLEM.create(PROBLEM.initial, Node(), Action(), 0));
+		Entry root(INITIAL, COST.f(INITIAL), nullptr, 0, ids++);
+		open.insert(&root);
+
+		// After the children of ENTRY changed, bring the F of it and its ancestors up to date.
+		auto const BACK_UP = [&](Entry *entry)
+		{
+			for(; entry && !entry->leaf(); entry = entry->parent)
+			{
+				auto const &BEST(*std::min_element(std::begin(entry->children), std::end(entry->children), [](std::unique_ptr<Entry> const &A, std::unique_ptr<Entry> const &B){ return A->f < B->f; }));
+				if(BEST->f == entry->f)
+					break;
+				bool const PRUNABLE(prunable.erase(entry));
+				entry->f = BEST->f;
+				if(PRUNABLE)
+					prunable.insert(entry);
+			}
+		};
+
+		// Forget the children of ENTRY, which are all leaves, so that it becomes a leaf.
+		auto const PRUNE = [&](Entry *entry)
+		{
+			prunable.erase(entry);
+			for(auto const &CHILD : entry->children)
+			{
+				open.erase(CHILD.get());
+				observer.pruned();
+			}
+			memory -= entry->children.size();
+			entry->children.clear();
+			open.insert(entry);
+			if(entry->parent && entry->parent->frontier_parent())
+				prunable.insert(entry->parent);
+		};
+
+		while(!open.empty() && (*std::begin(open))->f != INF)
+		{
+			Entry *const S(*std::begin(open));
+			open.erase(std::begin(open));
+			observer.popped();
+
+			if(observer.measure(phase::goal_test, [&]{ return PROBLEM.goal_test(S->node->state()); }))
+				return S->node;
+
+			observer.expanded(S->node, COST);
+			detail::for_each_action(PROBLEM, S->node->state(), [&](Action const &ACTION)
+			{
+				auto const CHILD(observer.measure(phase::child, [&]{ return PROBLEM.child(S->node, ACTION); }));
+				S->children.emplace_back(new Entry(CHILD, std::max(S->f, COST.f(CHILD)), S, S->depth + 1, ids++));
+				open.insert(S->children.back().get());
+				observer.pushed();
+			}, observer);
+			memory += S->children.size();
+
+			if(S->leaf())
+			{
+				// A dead end.
+				S->f = INF;
+				open.insert(S);
+				BACK_UP(S->parent);
+			}
+			else
+			{
+				if(S->parent)
+					prunable.erase(S->parent);
+				BACK_UP(S);
+				prunable.insert(S);
+			}
+
+			while(memory > BOUND)
+			{
+				auto worst(std::begin(prunable));
+				if(*worst == S)
+					++worst;
+				if(worst != std::end(prunable))
+					PRUNE(*worst);
+				else
+				{
+					// There is no room for S and its children.
+					PRUNE(S);
+					open.erase(S);
+					S->f = INF;
+					open.insert(S);
+					BACK_UP(S->parent);
+				}
+			}
+
+			observer.sizes(open.size(), memory);
+		}
+
+		throw goal_not_found();
+	}
+}
+
+#endif // MEMORY_BOUNDED_SEARCH_H
@@ -0,0 +1,482 @@
+/*
+    parallelsearch.hpp: Hash-distributed parallel best-first search.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file parallelsearch.hpp
+ * @brief Multi-threaded graph search functions.
+ */
+
+#ifndef PARALLEL_SEARCH_H
+#define PARALLEL_SEARCH_H
+
+#include "bestfirstsearch.hpp"
+#include "utils/mpsc_queue.hpp"
+#include "utils/multiqueue.hpp"
+#include "utils/striped_table.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace jsearch
+{
+	namespace detail
+	{
+		/**
+		 * @brief What one thread of parallel_best_first_search owns: the states whose hash maps to it.
+		 */
+		template <class Frontier, class Closed, typename Node>
+		struct hda_worker
+		{
+			Frontier frontier;
+			Closed closed; // State ↦ the g it was expanded with.
+			mpsc_queue<Node> inbox; // Children generated by other threads.
+		};
+	}
+
+
+	/**************************************
+	 *	Hash-distributed graph search (HDA*)  *
+	 **************************************/
+	/**
+	 * @brief Graph search on THREADS threads, after Kishimoto, Fukunaga & Botea's HDA* (2009).
+	 *
+	 * Every state is owned by the thread that its hash selects.  Each thread has its own frontier and closed
+	 * Map, and hands every child it generates to the owner of the child's state through a lock-free queue.
+	 *
+	 * Because threads do not expand nodes in global f order, the first goal found is only an incumbent: a
+	 * state is re-opened if it is reached again with a lower g, nodes whose f is not below the incumbent's
+	 * cost are pruned, and the search ends when no thread has work and no child is in transit.  So the
+	 * result is optimal whenever sequential best_first_search would be.
+	 *
+	 * The Problem's policies are called concurrently from all threads, so they must not modify shared
+	 * state.  In particular, ArenaNodeCreator cannot be used here.
+	 *
+	 * There is one thread for each of the observers, and each thread only tells its own, so the limits of a
+	 * budgeted apply to each thread.  The sizes that a thread reports are those of its own frontier and
+	 * closed Map.  When any Observer throws, every thread stops and the exception is thrown from here.
+	 *
+	 * @return The path cost of the goal.
+	 *
+	 * @throws goal_not_found
+	 * @throws std::invalid_argument if there are no observers.
+	 */
+	template <template <typename T, typename Comparator> class PriorityQueue,
+			template <typename Traits> class Comparator,
+			template <typename Key, typename Value> class Map,
+			typename Traits,
+			template <typename Traits_> class StepCostPolicy,
+			template <typename Traits_> class ActionsPolicy,
+			template <typename Traits_> class ResultPolicy,
+			template <typename Traits_> class GoalTestPolicy,
+			template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy,
+				template <typename Traits__> class ResultPolicy,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy,
+			typename Output,
+			class Observer>
+	typename Traits::pathcost parallel_best_first_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Output path, std::vector<Observer> &observers)
+	{
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+		typedef typename Traits::action Action;
+		typedef typename Traits::pathcost PathCost;
+		typedef jsearch::queue_set<PriorityQueue<Node, Comparator<Traits>>, Map> Frontier;
+		typedef detail::hda_worker<Frontier, Map<State, PathCost>, Node> Worker;
+
+		if(observers.empty())
+			throw std::invalid_argument("no observers");
+
+		auto const T(unsigned(observers.size()));
+		Comparator<Traits> const COMPARE;
+		std::hash<State> const HASH;
+		std::vector<std::unique_ptr<Worker>> workers;
+		for(unsigned i(0); i != T; ++i)
+			workers.emplace_back(new Worker);
+
+		/*	work counts the threads that are busy plus the children in transit, so it is only zero when the
+		 *	search is over.  A thread becomes busy before it accounts for a child it has received.	*/
+		std::atomic<long> work(T + 1);
+		std::atomic<bool> abort(false);
+		std::atomic<PathCost> incumbent(std::numeric_limits<PathCost>::max());
+		std::mutex goal_mutex;
+		Node goal; // The best goal node so far, protected by goal_mutex.
+		std::vector<std::exception_ptr> errors(T);
+
+		workers[HASH(PROBLEM.initial) % T]->inbox.push(PROBLEM.create(PROBLEM.initial, Node(), Action(), 0));
+
+		auto const SEARCH = [&](unsigned const ID)
+		{
+			Worker &self(*workers[ID]);
+			Observer &observer(observers[ID]);
+
+			// Put CHILD on the frontier unless the state was already reached as cheaply.
+			auto const RECEIVE = [&](Node const &CHILD)
+			{
+				auto const IT(self.closed.find(CHILD->state()));
+				if(IT != std::end(self.closed))
+				{
+					if(IT->second <= CHILD->path_cost())
+					{
+						observer.discarded();
+						return;
+					}
+					self.closed.erase(IT); // Re-open the state.
+				}
+				detail::handle_child(self.frontier, CHILD, observer);
+			};
+
+			bool busy(true);
+
+			try
+			{
+				detail::observation<Observer> const OBSERVATION(observer);
+				while(!abort.load(std::memory_order_relaxed))
+				{
+					Node received;
+					while(self.inbox.pop(received))
+					{
+						if(!busy)
+						{
+							++work;
+							busy = true;
+						}
+						RECEIVE(received);
+						--work;
+					}
+
+					// The frontier is ordered on f, so if the top cannot beat the incumbent then nothing can.
+					if(!self.frontier.empty() && !(COMPARE.f(self.frontier.top()) < incumbent.load(std::memory_order_relaxed)))
+					{
+						for(std::size_t i(0); i != self.frontier.size(); ++i)
+							observer.pruned();
+						self.frontier.clear();
+					}
+
+					if(self.frontier.empty())
+					{
+						if(busy)
+						{
+							busy = false;
+							--work;
+						}
+						if(work.load() == 0)
+							break;
+						std::this_thread::yield();
+						continue;
+					}
+
+					auto const S(detail::pop(self.frontier));
+					observer.popped();
+					if(detail::refine(PROBLEM, S, observer))
+					{
+						self.frontier.push(S);
+						continue;
+					}
+
+					if(observer.measure(phase::goal_test, [&]{ return PROBLEM.goal_test(S->state()); }))
+					{
+						std::lock_guard<std::mutex> const LOCK(goal_mutex);
+						if(S->path_cost() < incumbent.load())
+						{
+							incumbent.store(S->path_cost());
+							goal = S;
+						}
+						continue;
+					}
+
+					observer.expanded(S, COMPARE);
+					self.closed[S->state()] = S->path_cost();
+					detail::for_each_action(PROBLEM, S->state(), [&](Action const &ACTION)
+					{
+						auto const SUCCESSOR(observer.measure(phase::child, [&]{ return PROBLEM.result(S->state(), ACTION); }));
+						auto const CHILD(observer.measure(phase::child, [&]{ return PROBLEM.child(S, ACTION, SUCCESSOR); }));
+
+						if(!(COMPARE.f(CHILD) < incumbent.load(std::memory_order_relaxed)))
+						{
+							observer.pruned();
+							return;
+						}
+
+						auto const OWNER(HASH(SUCCESSOR) % T);
+						if(OWNER == ID)
+							RECEIVE(CHILD);
+						else
+						{
+							++work;
+							workers[OWNER]->inbox.push(CHILD);
+						}
+					}, observer);
+					observer.sizes(self.frontier.size(), self.closed.size());
+				}
+			}
+			catch(...)
+			{
+				errors[ID] = std::current_exception();
+				abort = true;
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for(unsigned i(1); i != T; ++i)
+			threads.emplace_back(SEARCH, i);
+		SEARCH(0);
+		for(auto &thread : threads)
+			thread.join();
+
+		for(auto const &ERROR : errors)
+			if(ERROR)
+				std::rethrow_exception(ERROR);
+
+		if(!goal)
+			throw goal_not_found();
+
+		detail::unravel(path, goal);
+		return goal->path_cost();
+	}
+
+
+	// As above, on THREADS threads that have no Observer.
+	template <template <typename T, typename Comparator> class PriorityQueue,
+			template <typename Traits> class Comparator,
+			template <typename Key, typename Value> class Map,
+			typename Traits,
+			template <typename Traits_> class StepCostPolicy,
+			template <typename Traits_> class ActionsPolicy,
+			template <typename Traits_> class ResultPolicy,
+			template <typename Traits_> class GoalTestPolicy,
+			template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy,
+				template <typename Traits__> class ResultPolicy,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy,
+			typename Output>
+	typename Traits::pathcost parallel_best_first_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Output path, unsigned const THREADS = std::thread::hardware_concurrency())
+	{
+		std::vector<null_observer> observers(THREADS ? THREADS : 1u);
+		return parallel_best_first_search<PriorityQueue, Comparator, Map>(PROBLEM, path, observers);
+	}
+
+
+	/*******************************************
+	 *	Shared-frontier graph search (MultiQueue)  *
+	 *******************************************/
+	/**
+	 * @brief Graph search on THREADS threads that share one relaxed frontier, a multiqueue of
+	 * QUEUES_PER_THREAD heaps per thread, and one striped_table of the best g with which each state has been
+	 * pushed.
+	 *
+	 * A child is only pushed if its g is below the best so far for its state, which then becomes the child's.
+	 * So a state is pushed again when it is reached more cheaply, which is the DECREASE-KEY, and a node
+	 * whose g is no longer the best for its state is dropped when it is popped.
+	 *
+	 * The frontier is only roughly in order, so as with parallel_best_first_search the first goal is only an
+	 * incumbent, a state may be expanded again with a lower g, and nodes whose f is not below the incumbent's
+	 * cost are pruned.  The search ends when the frontier is empty and no thread is expanding, and the result
+	 * is optimal whenever sequential best_first_search would be.  The relaxation, and so the re-expansion
+	 * that it causes, grows with QUEUES_PER_THREAD, while contention for the locks of the heaps shrinks.
+	 *
+	 * The Problem's policies are called concurrently from all threads, so they must not modify shared
+	 * state.  In particular, ArenaNodeCreator cannot be used here.
+	 *
+	 * There is one thread for each of the observers, and each thread only tells its own, as for
+	 * parallel_best_first_search.  The sizes that a thread reports are those of the shared frontier, and of
+	 * the states in the table that are not on it, as they were when it looked.
+	 *
+	 * @return The path cost of the goal.
+	 *
+	 * @throws goal_not_found
+	 * @throws std::invalid_argument if there are no observers.
+	 */
+	template <template <typename Traits> class Comparator,
+			typename Traits,
+			template <typename Traits_> class StepCostPolicy,
+			template <typename Traits_> class ActionsPolicy,
+			template <typename Traits_> class ResultPolicy,
+			template <typename Traits_> class GoalTestPolicy,
+			template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy,
+				template <typename Traits__> class ResultPolicy,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy,
+			typename Output,
+			class Observer>
+	typename Traits::pathcost shared_frontier_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Output path, std::vector<Observer> &observers, unsigned const QUEUES_PER_THREAD = 2)
+	{
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+		typedef typename Traits::action Action;
+		typedef typename Traits::pathcost PathCost;
+
+		if(observers.empty())
+			throw std::invalid_argument("no observers");
+
+		auto const T(unsigned(observers.size()));
+		Comparator<Traits> const COMPARE;
+		multiqueue<Node, Comparator<Traits>> frontier(T * std::max(QUEUES_PER_THREAD, 1u), COMPARE);
+		striped_table<State, PathCost> best(64 * T); // State ↦ the lowest g with which it has been pushed.
+		std::atomic<std::size_t> states(1); // The size of best, to report without locking every stripe.
+
+		/*	pending counts the nodes on the frontier plus those being expanded, so it is only zero when the
+		 *	search is over.  A node is only accounted for once its children have been pushed.	*/
+		std::atomic<long> pending(1);
+		std::atomic<bool> abort(false);
+		std::atomic<PathCost> incumbent(std::numeric_limits<PathCost>::max());
+		std::mutex goal_mutex;
+		Node goal; // The best goal node so far, protected by goal_mutex.
+		std::vector<std::exception_ptr> errors(T);
+
+		best.visit(PROBLEM.initial, [](PathCost &g, bool){ g = 0; });
+		frontier.push(PROBLEM.create(PROBLEM.initial, Node(), Action(), 0));
+
+		auto const SEARCH = [&](unsigned const ID)
+		{
+			Observer &observer(observers[ID]);
+
+			try
+			{
+				detail::observation<Observer> const OBSERVATION(observer);
+				while(!abort.load(std::memory_order_relaxed))
+				{
+					Node S;
+					if(!frontier.pop(S))
+					{
+						if(pending.load() == 0)
+							break;
+						std::this_thread::yield();
+						continue;
+					}
+					observer.popped();
+
+					bool const CURRENT(best.visit(S->state(), [&](PathCost const &G, bool){ return !(G < S->path_cost()); }));
+					if(CURRENT && COMPARE.f(S) < incumbent.load(std::memory_order_relaxed))
+					{
+						if(detail::refine(PROBLEM, S, observer))
+						{
+							++pending;
+							frontier.push(S);
+						}
+						else if(observer.measure(phase::goal_test, [&]{ return PROBLEM.goal_test(S->state()); }))
+						{
+							std::lock_guard<std::mutex> const LOCK(goal_mutex);
+							if(S->path_cost() < incumbent.load())
+							{
+								incumbent.store(S->path_cost());
+								goal = S;
+							}
+						}
+						else
+						{
+							observer.expanded(S, COMPARE);
+							detail::for_each_action(PROBLEM, S->state(), [&](Action const &ACTION)
+							{
+								auto const SUCCESSOR(observer.measure(phase::child, [&]{ return PROBLEM.result(S->state(), ACTION); }));
+								auto const CHILD(observer.measure(phase::child, [&]{ return PROBLEM.child(S, ACTION, SUCCESSOR); }));
+
+								if(!(COMPARE.f(CHILD) < incumbent.load(std::memory_order_relaxed)))
+								{
+									observer.pruned();
+									return;
+								}
+
+								if(best.visit(SUCCESSOR, [&](PathCost &g, bool const INSERTED)
+								{
+									if(!INSERTED && !(CHILD->path_cost() < g))
+										return false;
+									if(INSERTED)
+										states.fetch_add(1, std::memory_order_relaxed);
+									g = CHILD->path_cost();
+									return true;
+								}))
+								{
+									++pending;
+									frontier.push(CHILD);
+									observer.pushed();
+								}
+								else
+									observer.discarded();
+							}, observer);
+							auto const FRONTIER(frontier.size()), STATES(states.load(std::memory_order_relaxed));
+							observer.sizes(FRONTIER, STATES > FRONTIER ? STATES - FRONTIER : 0);
+						}
+					}
+					else if(CURRENT)
+						observer.pruned();
+
+					--pending;
+				}
+			}
+			catch(...)
+			{
+				errors[ID] = std::current_exception();
+				abort = true;
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for(unsigned i(1); i != T; ++i)
+			threads.emplace_back(SEARCH, i);
+		SEARCH(0);
+		for(auto &thread : threads)
+			thread.join();
+
+		for(auto const &ERROR : errors)
+			if(ERROR)
+				std::rethrow_exception(ERROR);
+
+		if(!goal)
+			throw goal_not_found();
+
+		detail::unravel(path, goal);
+		return goal->path_cost();
+	}
+
+
+	// As above, on THREADS threads that have no Observer.
+	template <template <typename Traits> class Comparator,
+			typename Traits,
+			template <typename Traits_> class StepCostPolicy,
+			template <typename Traits_> class ActionsPolicy,
+			template <typename Traits_> class ResultPolicy,
+			template <typename Traits_> class GoalTestPolicy,
+			template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy,
+				template <typename Traits__> class ResultPolicy,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy,
+			typename Output>
+	typename Traits::pathcost shared_frontier_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Output path, unsigned const THREADS = std::thread::hardware_concurrency(), unsigned const QUEUES_PER_THREAD = 2)
+	{
+		std::vector<null_observer> observers(THREADS ? THREADS : 1u);
+		return shared_frontier_search<Comparator>(PROBLEM, path, observers, QUEUES_PER_THREAD);
+	}
+}
+
+#endif // PARALLEL_SEARCH_H
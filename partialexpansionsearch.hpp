@@ -0,0 +1,228 @@
+/*
+    partialexpansionsearch.hpp: Partial-expansion A* (PEA*).
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file partialexpansionsearch.hpp
+ * @brief Graph search that only puts on the frontier the children that it is about to need.
+ */
+
+#ifndef PARTIAL_EXPANSION_SEARCH_H
+#define PARTIAL_EXPANSION_SEARCH_H
+
+#include "bestfirstsearch.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace jsearch
+{
+	namespace detail
+	{
+		/**
+		 * @brief A node on the frontier of partial_expansion_search, with the range of increases in f, from
+		 * the node to its children, that its next expansion will generate.
+		 *
+		 * F, the node's f plus HIGH, orders the frontier.  A node that has not been expanded yet has no lower
+		 * bound, and a node that is put back after an expansion has LOW == HIGH.
+		 */
+		template <typename Node, typename Cost>
+		struct partial_entry
+		{
+			partial_entry() : node(), F(), low(), high(), resumed(false) {}
+			partial_entry(Node const &NODE, Cost const &F_, Cost const &LOW, Cost const &HIGH, bool const RESUMED) : node(NODE), F(F_), low(LOW), high(HIGH), resumed(RESUMED) {}
+
+			Node node;
+			Cost F, low, high;
+			bool resumed;
+		};
+
+
+		template <typename Node, typename Cost>
+		struct partial_order
+		{
+			partial_order() {}
+
+			bool operator()(partial_entry<Node, Cost> const &A, partial_entry<Node, Cost> const &B) const
+			{
+				return A.F > B.F;
+			}
+		};
+
+
+		// The operator selection function of an ActionsPolicy, actions(STATE, LOW, HIGH, visit), generates the children.
+		template <class Problem, typename Cost, typename Visitor, typename Offer, class Observer>
+		inline auto select_actions(Problem const &PROBLEM, typename Problem::State const &STATE, Cost const &LOW, Cost const &HIGH, Visitor &visit, Offer &, Observer &, int) -> decltype(Cost(PROBLEM.actions(STATE, LOW, HIGH, visit)))
+		{
+			return PROBLEM.actions(STATE, LOW, HIGH, visit);
+		}
+
+
+		// Otherwise every child is generated and offered, and offer(ACTION) returns the increase in f to it.
+		template <class Problem, typename Cost, typename Visitor, typename Offer, class Observer>
+		inline Cost select_actions(Problem const &PROBLEM, typename Problem::State const &STATE, Cost const &, Cost const &HIGH, Visitor &, Offer &offer, Observer &observer, long)
+		{
+			auto next(std::numeric_limits<Cost>::max());
+			for_each_action(PROBLEM, STATE, [&](typename Problem::Action const &ACTION)
+			{
+				auto const DELTA(offer(ACTION));
+				if(HIGH < DELTA)
+					next = std::min(next, DELTA);
+			}, observer);
+			return next;
+		}
+	}
+
+
+	/*****************************************
+	 *	Partial-expansion A* (PEA*)	 	 	 *
+	 *****************************************/
+	/**
+	 * @brief Graph search with a unified state Table after Yoshizumi, Miura and Ishida (2000), and the
+	 * operator selection function of Felner et al. (2012).
+	 *
+	 * When a node is expanded, only the children whose f equals the node's stored F are put on the frontier.
+	 * The node then goes back on the frontier with the next F at which it has a child, or is closed once every
+	 * child has been generated.  Children whose f is above the cost of the solution are therefore never put on
+	 * the frontier or in the Table.  CostFunction orders the frontier, and its heuristic must be consistent.
+	 *
+	 * The ActionsPolicy may also provide the operator selection function actions(STATE, LOW, HIGH, visit),
+	 * which calls visit(ACTION) for only the actions whose increase in the CostFunction's f, from STATE to the
+	 * child, is in [LOW, HIGH], and returns the least increase above HIGH, or the maximum Cost if none is.  The
+	 * other children are then not even generated.  Otherwise every child is generated at each expansion and the
+	 * others are forgotten.
+	 *
+	 * Table must be like state_table.  The Observer is told about each expansion, partial or not.
+	 *
+	 * @return The path cost of the goal, whose path is written from the goal back to the initial state.
+	 *
+	 * @throws goal_not_found
+	 */
+	template <template <typename Traits> class CostFunction,
+			template <typename T, typename Comparator> class PriorityQueue,
+			template <typename Key, typename Value> class Table,
+			typename Traits,
+			template <typename Traits_> class StepCostPolicy,
+			template <typename Traits_> class ActionsPolicy,
+			template <typename Traits_> class ResultPolicy,
+			template <typename Traits_> class GoalTestPolicy,
+			template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy,
+				template <typename Traits__> class ResultPolicy,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy,
+			typename Output,
+			typename Observer = null_observer>
+	typename Traits::pathcost partial_expansion_search(Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy> const &PROBLEM, Output path, Observer &&observer = Observer())
+	{
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+		typedef typename Traits::action Action;
+		typedef typename Traits::pathcost PathCost;
+		typedef typename CostFunction<Traits>::Cost Cost;
+		typedef detail::partial_entry<Node, Cost> Entry;
+		typedef PriorityQueue<Entry, detail::partial_order<Node, Cost>> Frontier;
+		typedef detail::table_entry<typename Frontier::handle_type, PathCost> Known;
+
+		detail::release_guard<Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy>> const RELEASE(PROBLEM);
+		detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+		CostFunction<Traits> const COST;
+		Frontier frontier;
+		Table<State, Known> table;
+
+		auto const START(PROBLEM.create(PROBLEM.initial, Node(), Action(), 0));
+		Known &initial(*table.insert(START->state()).first);
+		initial.open = true;
+		initial.handle = frontier.push(Entry(START, COST.f(START), std::numeric_limits<Cost>::lowest(), Cost(0), false));
+
+		while(!frontier.empty())
+		{
+			auto const E(detail::pop(frontier));
+			auto const &S(E.node);
+			observer.popped();
+
+			// A node that is put back was not the goal the first time.
+			if(!E.resumed && observer.measure(phase::goal_test, [&]{ return PROBLEM.goal_test(S->state()); }))
+			{
+				detail::unravel(path, S);
+				return S->path_cost();
+			}
+
+			auto const F(COST.f(S));
+
+			auto const PUT = [&](State const &SUCCESSOR, Node const &CHILD)
+			{
+				auto const INSERTED(table.insert(SUCCESSOR));
+				Known &known(*INSERTED.first);
+				if(INSERTED.second)
+				{
+					known.open = true;
+					known.handle = frontier.push(Entry(CHILD, COST.f(CHILD), std::numeric_limits<Cost>::lowest(), Cost(0), false));
+					observer.pushed();
+				}
+				else if(known.open && CHILD->path_cost() < (*known.handle).node->path_cost())
+				{
+					frontier.increase(known.handle, Entry(CHILD, COST.f(CHILD), std::numeric_limits<Cost>::lowest(), Cost(0), false)); // The DECREASE-KEY operation is an increase because it is a max-heap.
+					observer.decreased();
+				}
+				else
+					observer.discarded();
+			};
+
+			// The children in range, as selected by the ActionsPolicy.
+			auto VISIT = [&](Action const &ACTION)
+			{
+				auto const SUCCESSOR(observer.measure(phase::child, [&]{ return PROBLEM.result(S->state(), ACTION); }));
+				PUT(SUCCESSOR, observer.measure(phase::child, [&]{ return PROBLEM.child(S, ACTION, SUCCESSOR); }));
+			};
+
+			// Every child, of which only those in range are kept.
+			auto OFFER = [&](Action const &ACTION)
+			{
+				auto const SUCCESSOR(observer.measure(phase::child, [&]{ return PROBLEM.result(S->state(), ACTION); }));
+				auto const CHILD(observer.measure(phase::child, [&]{ return PROBLEM.child(S, ACTION, SUCCESSOR); }));
+				Cost const DELTA(COST.f(CHILD) - F);
+				if(!(DELTA < E.low) && !(E.high < DELTA))
+					PUT(SUCCESSOR, CHILD);
+				return DELTA;
+			};
+
+			// S is off the frontier, so a child of its own state must not take it for an open duplicate.
+			Known &closing(*table.find(S->state()));
+			closing.open = false;
+			closing.g = S->path_cost();
+
+			observer.expanded(S, COST);
+			auto const NEXT(detail::select_actions(PROBLEM, S->state(), E.low, E.high, VISIT, OFFER, observer, 0));
+
+			if(NEXT != std::numeric_limits<Cost>::max())
+			{
+				Known &expanding(*table.find(S->state())); // PUT may have moved it.
+				expanding.open = true;
+				expanding.handle = frontier.push(Entry(S, F + NEXT, NEXT, NEXT, true));
+			}
+
+			observer.sizes(frontier.size(), table.size() - frontier.size());
+		}
+
+		throw goal_not_found();
+	}
+}
+
+#endif // PARTIAL_EXPANSION_SEARCH_H
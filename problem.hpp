@@ -24,18 +24,151 @@
 #ifndef PROBLEM_H
 #define PROBLEM_H
 
-#ifndef NDEBUG
-#include <iostream>
-#include <typeinfo>
-
-#include "to_string.hpp"
-#endif
+#include "utils/arena.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 
 namespace jsearch
 {
+	namespace detail
+	{
+		/**
+		 * @brief Call CREATOR.release() if the CreatePolicy has one, otherwise do nothing.
+		 */
+		template <class CreatePolicy>
+		inline auto release_nodes(CreatePolicy const &CREATOR, int) -> decltype(CREATOR.release())
+		{
+			return CREATOR.release();
+		}
+
+
+		template <class CreatePolicy>
+		inline void release_nodes(CreatePolicy const &, long) {}
+
+
+		/**
+		 * @brief Call CREATOR.refine(NODE) if the CreatePolicy has one, otherwise NODE is already final.
+		 */
+		template <class CreatePolicy, typename Node>
+		inline auto refine_node(CreatePolicy const &CREATOR, Node const &NODE, int) -> decltype(CREATOR.refine(NODE))
+		{
+			return CREATOR.refine(NODE);
+		}
+
+
+		template <class CreatePolicy, typename Node>
+		inline bool refine_node(CreatePolicy const &, Node const &, long) { return false; }
+
+
+		/**
+		 * @brief Whether a CostPolicy, CreatePolicy or Problem has a public lazy member that is true (see AStar
+		 * and EvaluatingNodeCreator).
+		 */
+		template <class CostPolicy, typename = void>
+		struct evaluates_lazily : std::false_type {};
+
+
+		template <class CostPolicy>
+		struct evaluates_lazily<CostPolicy, typename std::enable_if<CostPolicy::lazy>::type> : std::true_type {};
+
+
+		/**
+		 * @brief Whether a CostPolicy, CreatePolicy or Problem has a public batched member that is true (see AStar
+		 * and EvaluatingNodeCreator).
+		 */
+		template <class Policy, typename = void>
+		struct evaluates_in_batches : std::false_type {};
+
+
+		template <class Policy>
+		struct evaluates_in_batches<Policy, typename std::enable_if<Policy::batched>::type> : std::true_type {};
+
+
+		/**
+		 * @brief Call CREATOR.evaluate(NODES, N) if the CreatePolicy has one, otherwise the nodes are already final.
+		 */
+		template <class CreatePolicy, typename Node>
+		inline auto evaluate_nodes(CreatePolicy const &CREATOR, Node const *NODES, std::size_t const N, int) -> decltype(CREATOR.evaluate(NODES, N))
+		{
+			return CREATOR.evaluate(NODES, N);
+		}
+
+
+		template <class CreatePolicy, typename Node>
+		inline void evaluate_nodes(CreatePolicy const &, Node const *, std::size_t, long) {}
+
+
+		/**
+		 * @brief The f and tie-breaking key of an EvaluatedNode, and which of two nodes comes off the frontier
+		 * later: the one with the greater f, or with the same f and the greater key.
+		 */
+		template <typename Cost, typename = void>
+		class node_evaluation
+		{
+		public:
+			node_evaluation() : f_(), key_() {}
+
+			Cost f() const { return f_; }
+			Cost key() const { return key_; }
+			void set(Cost const &F, Cost const &KEY) { f_ = F; key_ = KEY; }
+
+			bool after(node_evaluation const &OTHER) const
+			{
+				return f_ == OTHER.f_ ? key_ > OTHER.key_ : f_ > OTHER.f_;
+			}
+
+		private:
+			Cost f_;
+			Cost key_;
+		};
+
+
+		/**
+		 * @brief An integral f and key of up to 32 bits each are packed into one 64-bit integer, f in the high half,
+		 * so that one comparison orders two nodes on both.  Each is offset by the least Cost first, so that the
+		 * order of the unsigned bits is that of the Cost even if it is signed.
+		 */
+		template <typename Cost>
+		class node_evaluation<Cost, typename std::enable_if<std::is_integral<Cost>::value && sizeof(Cost) <= 4>::type>
+		{
+		public:
+			node_evaluation() : packed(pack(Cost(), Cost())) {}
+
+			Cost f() const { return unpack(packed >> 32); }
+			Cost key() const { return unpack(packed & UINT32_MAX); }
+			void set(Cost const &F, Cost const &KEY) { packed = pack(F, KEY); }
+
+			bool after(node_evaluation const &OTHER) const { return packed > OTHER.packed; }
+
+		private:
+			static std::uint64_t pack(Cost const F, Cost const KEY)
+			{
+				return static_cast<std::uint64_t>(offset(F)) << 32 | offset(KEY);
+			}
+
+			static std::uint32_t offset(Cost const C)
+			{
+				return static_cast<std::uint32_t>(static_cast<std::int64_t>(C) - std::numeric_limits<Cost>::min());
+			}
+
+			static Cost unpack(std::uint64_t const BITS)
+			{
+				return static_cast<Cost>(static_cast<std::int64_t>(BITS) + std::numeric_limits<Cost>::min());
+			}
+
+			std::uint64_t packed;
+		};
+	}
+
+
 	template <typename Traits>
 	class DefaultNodeCreator
 	{
@@ -74,6 +207,40 @@ namespace jsearch
 	};
 
 
+	/**
+	 * ArenaNodeCreator constructs DefaultNodes in a slab arena instead of allocating each one separately, so
+	 * Traits::node is a bald pointer, e.g. DefaultNode<Traits> *.
+	 *
+	 * Graph search releases all of the nodes at once when it returns.  Nodes returned by tree search and
+	 * recursive best-first search remain valid until the next graph search or until the Problem is destroyed.
+	 * A Problem using this policy must not be shared between threads.
+	 */
+	template <typename Traits>
+	class ArenaNodeCreator
+	{
+	public:
+		// Destroy every node created so far.
+		void release() const { nodes.clear(); }
+
+	protected:
+		typedef typename Traits::node Node;
+		typedef typename Traits::state State;
+		typedef typename Traits::action Action;
+		typedef typename Traits::pathcost PathCost;
+
+		ArenaNodeCreator() {}
+		~ArenaNodeCreator() {}
+
+		Node create(State const &STATE, Node const &PARENT, Action const &ACTION, PathCost const &PATHCOST) const
+		{
+			return nodes.construct(STATE, PARENT, ACTION, PATHCOST);
+		}
+
+	private:
+		mutable arena<typename std::pointer_traits<Node>::element_type> nodes;
+	};
+
+
 	// Default- and ComboNode are the rare case of a concrete base class.
 	template <typename Traits>
 	class DefaultNode
@@ -102,16 +269,6 @@ namespace jsearch
 	};
 
 
-#ifndef NDEBUG
-	template <typename Traits>
-	std::ostream& operator<<(std::ostream& stream, DefaultNode<Traits> const &NODE)
-	{
-		stream << "{" << jwm::to_string(NODE.state()) << ", " << (NODE.parent() ? jwm::to_string(NODE.parent()->state()) : "nullptr") << ", " << NODE.action() << ", " << NODE.path_cost() << "}";
-		return stream;
-	}
-#endif
-
-
 	template <typename Traits>
 	class ComboNode
 	{
@@ -134,17 +291,144 @@ namespace jsearch
 		Action action_;
 		PathCost path_cost_;
 	};
+	
 
+	/**
+	 * EvaluatedNode extends one of the concrete nodes above with its evaluation, f, and a tie-breaking key.
+	 * Both are computed once, when the node is created by EvaluatingNodeCreator, and simply read back by
+	 * CachedComparator, instead of being recomputed in every comparison the priority queue makes.  If they are
+	 * integers of up to 32 bits they are stored packed in one, so that the comparison is a single one.
+	 *
+	 * A lazy EvaluatingNodeCreator only stores a lower bound on f, with a zero key, and evaluates the node
+	 * when it reaches the top of the frontier.
+	 */
+	template <typename Traits, template <typename Traits_> class NodeBase = DefaultNode>
+	class EvaluatedNode : public NodeBase<Traits>
+	{
+	public:
+		typedef typename Traits::cost Cost;
 
-#ifndef NDEBUG
-	template <typename Traits>
-	std::ostream& operator<<(std::ostream& stream, ComboNode<Traits> const &NODE)
+		// Forward everything else to the constructor of NodeBase.
+		template <typename... Args>
+		EvaluatedNode(Args&&... args) : NodeBase<Traits>(std::forward<Args>(args)...), evaluation_(), evaluated_(false) {}
+		EvaluatedNode(EvaluatedNode<Traits, NodeBase> &&OTHER) = default;
+		EvaluatedNode(EvaluatedNode<Traits, NodeBase> const &OTHER) = delete;
+		EvaluatedNode<Traits, NodeBase> &operator=(EvaluatedNode<Traits, NodeBase> const &OTHER) = delete;
+
+		Cost f() const { return evaluation_.f(); }
+		Cost key() const { return evaluation_.key(); }
+		bool evaluated() const { return evaluated_; }
+
+		// Whether this node comes off the frontier after OTHER (see CachedComparator).
+		bool after(EvaluatedNode<Traits, NodeBase> const &OTHER) const { return evaluation_.after(OTHER.evaluation_); }
+
+		void evaluate(Cost const &F, Cost const &KEY) { evaluation_.set(F, KEY); evaluated_ = true; }
+		void bound(Cost const &F) { evaluation_.set(F, Cost()); evaluated_ = false; }
+
+	private:
+		detail::node_evaluation<Cost> evaluation_;
+		bool evaluated_;
+	};
+
+
+	/**
+	 * EvaluatingNodeCreator creates the node with CreatePolicy and then stores f, from CostPolicy, and the
+	 * tie-breaking key, from KeyPolicy, on it.  Traits::node must point to an EvaluatedNode.
+	 *
+	 * If CostPolicy is lazy, as AStar is with a lazy_heuristic, a child only gets the greater of its parent's f
+	 * and its own g as a bound, which is admissible when the heuristic is.  The search calls refine() on each
+	 * node it pops, which evaluates the node and says whether its f went up, in which case the node goes back
+	 * on the frontier instead of being expanded.
+	 *
+	 * If CostPolicy is batched instead, as AStar is with a batch_heuristic, a child gets the same bound when it is
+	 * created, and the search then calls evaluate() once with all of the children of the expansion, before any of
+	 * them goes on the frontier.  A search that does not do that still finds them by refine(), as if lazy.  The
+	 * tie-breaking key is still computed for each node, so a KeyPolicy that does not call h, e.g. FalseTiePolicy,
+	 * gets the most out of the batch.
+	 */
+	template <typename Traits,
+		template <typename Traits_> class CostPolicy,
+		template <typename Traits_> class KeyPolicy,
+		template <typename Traits_> class CreatePolicy = DefaultNodeCreator>
+	class EvaluatingNodeCreator :	protected virtual CreatePolicy<Traits>,
+									protected virtual CostPolicy<Traits>,
+									protected virtual KeyPolicy<Traits>
 	{
-		stream << "{" << jwm::to_string(NODE.state()) << ", " << NODE.action() << ", " << NODE.path_cost() << "}";
-		return stream;
-	}
-#endif
-	
+		using CostPolicy<Traits>::f;
+		using KeyPolicy<Traits>::key;
+
+		static constexpr bool LAZY = detail::evaluates_lazily<CostPolicy<Traits>>::value;
+		static constexpr bool BATCHED = !LAZY && detail::evaluates_in_batches<CostPolicy<Traits>>::value;
+
+	public:
+		typedef typename Traits::node Node;
+
+		// Whether the children of an expansion are to be given to evaluate() together.
+		static constexpr bool batched = BATCHED;
+
+		// Whether nodes are only evaluated by refine(), when they are popped.
+		static constexpr bool lazy = LAZY;
+
+		void release() const { detail::release_nodes(static_cast<CreatePolicy<Traits> const &>(*this), 0); }
+
+		// Evaluate NODE if it only has a bound, and return whether its f went up.
+		bool refine(Node const &NODE) const
+		{
+			if(!(LAZY || BATCHED) || NODE->evaluated())
+				return false;
+			auto const BOUND(NODE->f());
+			NODE->evaluate(f(NODE), key(NODE));
+			return BOUND < NODE->f();
+		}
+
+		// Evaluate the N nodes at NODES together, if batched.
+		void evaluate(Node const *NODES, std::size_t const N) const
+		{
+			evaluate(NODES, N, std::integral_constant<bool, BATCHED>());
+		}
+
+	protected:
+		typedef typename Traits::state State;
+		typedef typename Traits::action Action;
+		typedef typename Traits::pathcost PathCost;
+		typedef typename Traits::cost Cost;
+
+		EvaluatingNodeCreator() {}
+		~EvaluatingNodeCreator() {}
+
+		Node create(State const &STATE, Node const &PARENT, Action const &ACTION, PathCost const &PATHCOST) const
+		{
+			Node const RESULT(CreatePolicy<Traits>::create(STATE, PARENT, ACTION, PATHCOST));
+			if((LAZY || BATCHED) && PARENT)
+				RESULT->bound(std::max<Cost>(PARENT->f(), PATHCOST));
+			else
+				RESULT->evaluate(f(RESULT), key(RESULT));
+			return RESULT;
+		}
+
+	private:
+		void evaluate(Node const *, std::size_t, std::false_type) const {}
+
+		void evaluate(Node const *NODES, std::size_t const N, std::true_type) const
+		{
+			// Each thread has its own buffers, which only ever grow, since a Problem may be shared by threads.
+			static thread_local std::vector<State> states;
+			static thread_local std::vector<PathCost> g;
+			static thread_local std::vector<Cost> values;
+			states.clear();
+			g.clear();
+			values.resize(N);
+			for(std::size_t i(0); i != N; ++i)
+			{
+				states.push_back(NODES[i]->state());
+				g.push_back(NODES[i]->path_cost());
+			}
+			CostPolicy<Traits>::f_batch(states.data(), g.data(), N, values.data());
+			for(std::size_t i(0); i != N; ++i)
+				NODES[i]->evaluate(values[i], key(NODES[i]));
+		}
+	};
+
 
 	template <typename Traits,
 		template <typename Traits_> class StepCostPolicy,
@@ -198,6 +482,7 @@ namespace jsearch
 		protected virtual ChildPolicy<Traits, StepCostPolicy, ResultPolicy, CreatePolicy>,
 		protected virtual CreatePolicy<Traits>
 	{
+		typedef Traits traits;
 		typedef typename Traits::node Node;
 		typedef typename Traits::state State;
 		typedef typename Traits::action Action;
@@ -205,6 +490,21 @@ namespace jsearch
 
 		Problem(State const &initial) : initial(initial) {}
 
+		// Release the nodes created so far, if the CreatePolicy owns them (see ArenaNodeCreator).
+		void release() const { detail::release_nodes(static_cast<CreatePolicy<Traits> const &>(*this), 0); }
+
+		// Finish evaluating a node that was popped, if the CreatePolicy is lazy, and return whether it got worse.
+		bool refine(Node const &NODE) const { return detail::refine_node(static_cast<CreatePolicy<Traits> const &>(*this), NODE, 0); }
+
+		// Whether the children of an expansion should be given to evaluate() together (see EvaluatingNodeCreator).
+		static constexpr bool batched = detail::evaluates_in_batches<CreatePolicy<Traits>>::value;
+
+		// Whether nodes are only evaluated by refine(), when they are popped (see EvaluatingNodeCreator).
+		static constexpr bool lazy = detail::evaluates_lazily<CreatePolicy<Traits>>::value;
+
+		// Evaluate the N children of one expansion at NODES, if the CreatePolicy evaluates in batches.
+		void evaluate(Node const *NODES, std::size_t const N) const { detail::evaluate_nodes(static_cast<CreatePolicy<Traits> const &>(*this), NODES, N, 0); }
+
 		using ChildPolicy<Traits, StepCostPolicy, ResultPolicy, CreatePolicy>::child;
 		using StepCostPolicy<Traits>::step_cost;
 		using ActionsPolicy<Traits>::actions;
@@ -214,6 +514,82 @@ namespace jsearch
 
         State const initial;
 	};
+
+
+	/**
+	 * Symmetric is the ReversePolicy of a BidirectionalProblem whose actions can all be undone at the same cost,
+	 * such as an undirected graph: the predecessors of a state are its successors.
+	 */
+	template <typename Traits,
+			 template <typename Traits_> class StepCostPolicy,
+			 template <typename Traits_> class ActionsPolicy,
+			 template <typename Traits_> class ResultPolicy>
+	class Symmetric :	protected virtual StepCostPolicy<Traits>,
+						protected virtual ActionsPolicy<Traits>,
+						protected virtual ResultPolicy<Traits>
+	{
+	protected:
+		typedef typename Traits::state State;
+		typedef typename Traits::action Action;
+
+		Symmetric() {}
+		~Symmetric() {}
+
+		// Call VISIT(PREDECESSOR, COST) for each state from which STATE can be reached for COST.
+		template <typename Visitor>
+		void predecessors(State const &STATE, Visitor &&visit) const
+		{
+			// Qualified, so as not to hide the same members of the Problem.
+			auto const UNDO = [&](Action const &ACTION){ visit(ResultPolicy<Traits>::result(STATE, ACTION), StepCostPolicy<Traits>::step_cost(STATE, ACTION)); };
+			successors(STATE, UNDO, 0);
+		}
+
+	private:
+		// The ActionsPolicy either visits its actions or returns them, as detail::for_each_action expects.
+		template <typename Visitor>
+		auto successors(State const &STATE, Visitor const &VISIT, int) const -> decltype(this->ActionsPolicy<Traits>::actions(STATE, VISIT), void())
+		{
+			ActionsPolicy<Traits>::actions(STATE, VISIT);
+		}
+
+		template <typename Visitor>
+		void successors(State const &STATE, Visitor const &VISIT, long) const
+		{
+			for(auto const &ACTION : ActionsPolicy<Traits>::actions(STATE))
+				VISIT(ACTION);
+		}
+	};
+
+
+	/**
+	 * BidirectionalProblem is a Problem with one known goal state, that can also be searched backwards from the
+	 * goal.  ReversePolicy provides predecessors(State, Visitor), which calls the visitor with each state that
+	 * has an action to the given state and the step cost of that action, as Symmetric does.
+	 */
+	template <typename Traits,
+			 template <typename Traits_> class StepCostPolicy,
+			 template <typename Traits_> class ActionsPolicy,
+			 template <typename Traits_> class ResultPolicy,
+			 template <typename Traits_> class GoalTestPolicy,
+			 template <typename Traits_> class ReversePolicy,
+			 template <typename Traits_> class CreatePolicy = DefaultNodeCreator,
+			 template <typename Traits_,
+				template <typename Traits__> class StepCostPolicy_,
+				template <typename Traits__> class ResultPolicy_,
+				template <typename Traits__> class CreatePolicy>
+				class ChildPolicy = DefaultChildPolicy>
+	struct BidirectionalProblem :
+		Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy>,
+		protected virtual ReversePolicy<Traits>
+	{
+		typedef typename Traits::state State;
+
+		BidirectionalProblem(State const &initial, State const &goal) : Problem<Traits, StepCostPolicy, ActionsPolicy, ResultPolicy, GoalTestPolicy, CreatePolicy, ChildPolicy>(initial), goal(goal) {}
+
+		using ReversePolicy<Traits>::predecessors;
+
+		State const goal;
+	};
 }
 
 #endif
@@ -0,0 +1,432 @@
+/*
+    searchcontext.hpp: Answer many queries on one Problem without rebuilding the search each time.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file searchcontext.hpp
+ * @brief A graph search whose frontier, state table and nodes are kept from one query to the next.
+ *
+ * A search that is stopped by its Observer, e.g. by budgeted, can be carried on with resume(), or saved to
+ * a snapshot and restored later, even by another process:
+ *
+ *   try { context.search(INITIAL, GOAL, path, budgeted<Traits>(LIMITS)); }
+ *   catch(budget_exhausted<Traits> const &) { std::ofstream file("search.snapshot", std::ios::binary); context.save(file); }
+ *   ...
+ *   context.restore("search.snapshot");
+ *   context.resume(path);
+ */
+
+#ifndef SEARCH_CONTEXT_H
+#define SEARCH_CONTEXT_H
+
+#include "bestfirstsearch.hpp"
+#include "utils/spill_file.hpp"
+#include "utils/state_serializer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace jsearch
+{
+	namespace detail
+	{
+		// The order of the sweep of search_context::distances, as a template of one parameter.
+		template <typename Traits>
+		using sweep_cost = Dijkstra<Traits>;
+
+
+		/**
+		 * @brief What the sweep of search_context::distances knows about one of its goals.
+		 */
+		template <typename PathCost>
+		struct sweep_goal
+		{
+			sweep_goal() : wanted(false), reached(false), g() {}
+
+			bool wanted, reached;
+			PathCost g;
+		};
+	}
+
+
+	/**
+	 * The file format of a snapshot of a search_context: a snapshot_header, the goal state, then the nodes
+	 * as (state, action, path cost, index of the parent) with each parent before its children, the indices
+	 * of the nodes on the frontier as uint64, and the closed states as (state, g).  States, actions and path
+	 * costs are written by state_serializer, and each index of a parent is a uint64, or the maximum if there
+	 * is none.  Like a trace, it is not portable between machines of different byte order.
+	 */
+	char const SNAPSHOT_MAGIC[8] = {'J', 'S', 'N', 'A', 'P', 'S', 'H', '1'};
+
+
+	struct snapshot_header
+	{
+		char magic[8];
+		std::uint64_t state_size, action_size, cost_size; // To check that the snapshot is of the same Problem.
+		std::uint64_t nodes, frontier, closed;
+	};
+
+
+	/**
+	 * search_context answers queries on one Problem with the graph search of best_first_search with a
+	 * unified state Table, such as state_table, but keeps the frontier and the table between queries.  A
+	 * state_table is cleared in O(1) by its generation counter and keeps its array, the PriorityQueue is
+	 * cleared but keeps its storage if it can, and a Problem with ArenaNodeCreator keeps its slabs of nodes.
+	 * So once the context has answered its largest query, a query allocates only what the policies do.
+	 *
+	 * Each query gives its own initial state and goal state, rather than PROBLEM.initial and the goal test
+	 * of the Problem.  The Comparator must therefore be right for any goal, e.g. SimpleComparator with
+	 * Dijkstra, or an AStar whose HeuristicPolicy looks up the current goal.
+	 *
+	 * If an Observer stops a search by throwing, or anything else throws, the frontier, table and nodes of
+	 * that search are kept until the next query, and resume() carries on with it.  The search can also be
+	 * saved to a snapshot, if the PriorityQueue can be iterated, as the heaps of Boost.Heap can, and the
+	 * State, Action and PathCost have a state_serializer.  restore() maps the snapshot and builds the search
+	 * again, so that restoring one snapshot before each of several resumes starts each from the same
+	 * frontier.  Closed states are only restored with their g, so a restored search can only be resumed
+	 * towards the goal that it had.  Since nodes must outlive their search, the Problem must not be used for
+	 * other searches in the meantime if it releases its nodes, as with ArenaNodeCreator.
+	 *
+	 * A search_context refers to its Problem, which must outlive it, and like the Problem it must not be
+	 * shared between threads.
+	 */
+	template <class Problem,
+			template <typename T, typename Comparator> class PriorityQueue,
+			template <typename Traits> class Comparator,
+			template <typename Key, typename Value> class Table>
+	class search_context
+	{
+		typedef typename Problem::traits Traits;
+		typedef typename Problem::Node Node;
+		typedef typename Problem::State State;
+		typedef typename Problem::Action Action;
+		typedef typename Problem::PathCost PathCost;
+		typedef PriorityQueue<Node, Comparator<Traits>> Frontier;
+		typedef PriorityQueue<Node, SimpleComparator<Traits, detail::sweep_cost>> SweepFrontier;
+
+	public:
+		explicit search_context(Problem const &PROBLEM) : problem(PROBLEM), goal(), interrupted(false) {}
+
+		/**
+		 * @brief Search from INITIAL to GOAL.
+		 *
+		 * @return The path cost of GOAL, whose path is written from GOAL back to INITIAL.
+		 *
+		 * @throws goal_not_found
+		 */
+		template <typename Output, typename Observer = null_observer>
+		PathCost search(State const &INITIAL, State const &GOAL, Output path, Observer &&observer = Observer())
+		{
+			forget();
+			reset(frontier, table);
+			goal = GOAL;
+			detail::table_start(problem, INITIAL, frontier, table);
+			interrupted = true;
+
+			detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+			return finish(detail::table_continue(problem, [&](Node const &NODE){ return NODE->state() == goal; }, frontier, table, COMPARE, observer), path);
+		}
+
+		/**
+		 * @brief Carry on with the search of the last query, or of restore(), which was stopped by an
+		 * exception.
+		 *
+		 * @return The path cost of its goal, whose path is written from the goal back to its initial state.
+		 *
+		 * @throws goal_not_found
+		 * @throws std::logic_error if there is no stopped search.
+		 */
+		template <typename Output, typename Observer = null_observer>
+		PathCost resume(Output path, Observer &&observer = Observer())
+		{
+			if(!interrupted)
+				throw std::logic_error("no search to resume");
+
+			detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+			return finish(detail::table_continue(problem, [&](Node const &NODE){ return NODE->state() == goal; }, frontier, table, COMPARE, observer), path);
+		}
+
+		/**
+		 * @brief Write the search that was stopped to OUT as a snapshot, for restore().
+		 *
+		 * Only the nodes on the frontier and their ancestors are written.  OUT should be opened in binary
+		 * mode, and its state tells whether the snapshot was written.
+		 *
+		 * @throws std::logic_error if there is no stopped search.
+		 */
+		void save(std::ostream &out) const
+		{
+			typedef state_serializer<State> StateBytes;
+			typedef state_serializer<Action> ActionBytes;
+			typedef state_serializer<PathCost> CostBytes;
+			typedef typename std::remove_reference<decltype(*Node())>::type Pointee;
+
+			if(!interrupted)
+				throw std::logic_error("no search to save");
+
+			// Flatten the frontier and the ancestors of its nodes to indices, each parent first.
+			std::unordered_map<Pointee const *, std::uint64_t> index;
+			std::vector<Node> nodes, ancestry;
+			std::vector<std::uint64_t> open;
+			for(auto const &NODE : frontier)
+			{
+				for(Node node(NODE); node && index.find(&*node) == std::end(index); node = node->parent())
+					ancestry.push_back(node);
+				for(auto ancestor(ancestry.rbegin()); ancestor != ancestry.rend(); ++ancestor)
+				{
+					index.emplace(&**ancestor, nodes.size());
+					nodes.push_back(*ancestor);
+				}
+				ancestry.clear();
+				open.push_back(index.find(&*NODE)->second);
+			}
+
+			snapshot_header header;
+			std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof header.magic);
+			header.state_size = StateBytes::size;
+			header.action_size = ActionBytes::size;
+			header.cost_size = CostBytes::size;
+			header.nodes = nodes.size();
+			header.frontier = open.size();
+			header.closed = table.size() - open.size();
+			out.write(reinterpret_cast<char const *>(&header), sizeof header);
+
+			std::vector<unsigned char> record(StateBytes::size + ActionBytes::size + CostBytes::size + sizeof(std::uint64_t));
+			StateBytes::write(goal, record.data());
+			out.write(reinterpret_cast<char const *>(record.data()), StateBytes::size);
+
+			for(auto const &NODE : nodes)
+			{
+				std::uint64_t const PARENT(NODE->parent() ? index.find(&*NODE->parent())->second : std::numeric_limits<std::uint64_t>::max());
+				StateBytes::write(NODE->state(), record.data());
+				ActionBytes::write(NODE->action(), record.data() + StateBytes::size);
+				CostBytes::write(NODE->path_cost(), record.data() + StateBytes::size + ActionBytes::size);
+				std::memcpy(record.data() + StateBytes::size + ActionBytes::size + CostBytes::size, &PARENT, sizeof PARENT);
+				out.write(reinterpret_cast<char const *>(record.data()), record.size());
+			}
+
+			out.write(reinterpret_cast<char const *>(open.data()), open.size() * sizeof(std::uint64_t));
+
+			table.for_each([&](State const &STATE, typename StateTable::mapped_type const &ENTRY)
+			{
+				if(!ENTRY.open)
+				{
+					StateBytes::write(STATE, record.data());
+					CostBytes::write(ENTRY.g, record.data() + StateBytes::size);
+					out.write(reinterpret_cast<char const *>(record.data()), StateBytes::size + CostBytes::size);
+				}
+			});
+		}
+
+		/**
+		 * @brief Replace whatever search the context has with the one in the snapshot at PATH, so that it can
+		 * be resumed.
+		 *
+		 * The nodes are created again by the Problem, and the snapshot is read where it is mapped.
+		 *
+		 * @throws std::runtime_error if PATH is not a snapshot of a search of this kind of Problem.
+		 * @throws std::system_error if PATH cannot be mapped.
+		 */
+		void restore(std::string const &PATH)
+		{
+			typedef state_serializer<State> StateBytes;
+			typedef state_serializer<Action> ActionBytes;
+			typedef state_serializer<PathCost> CostBytes;
+
+			mapped_file const SNAPSHOT(PATH);
+			snapshot_header header;
+			std::size_t const NODE_SIZE(StateBytes::size + ActionBytes::size + CostBytes::size + sizeof(std::uint64_t));
+			std::size_t const CLOSED_SIZE(StateBytes::size + CostBytes::size);
+			if(SNAPSHOT.size() < sizeof header)
+				throw std::runtime_error("not a snapshot");
+			std::memcpy(&header, SNAPSHOT.data(), sizeof header);
+			if(std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof header.magic) != 0 || header.state_size != StateBytes::size || header.action_size != ActionBytes::size || header.cost_size != CostBytes::size
+				|| SNAPSHOT.size() != sizeof header + StateBytes::size + header.nodes * NODE_SIZE + header.frontier * sizeof(std::uint64_t) + header.closed * CLOSED_SIZE)
+				throw std::runtime_error("not a snapshot of this search");
+
+			forget();
+			reset(frontier, table);
+			table.reserve(header.frontier + header.closed);
+			try
+			{
+				rebuild(header, SNAPSHOT.data() + sizeof header);
+			}
+			catch(...)
+			{
+				reset(frontier, table);
+				problem.release();
+				throw;
+			}
+			interrupted = true;
+		}
+
+		/**
+		 * @brief Find the path cost from SOURCE to each of the goals in [FIRST, LAST) with one Dijkstra sweep,
+		 * which stops as soon as every goal has been reached.
+		 *
+		 * The costs are written to costs in the order of the goals, with the maximum PathCost for a goal that
+		 * cannot be reached.  The Comparator is not used, since no heuristic can be right for every goal.
+		 *
+		 * @return costs after the last cost was written.
+		 */
+		template <typename ForwardIterator, typename Output, typename Observer = null_observer>
+		Output distances(State const &SOURCE, ForwardIterator const FIRST, ForwardIterator const LAST, Output costs, Observer &&observer = Observer())
+		{
+			detail::release_guard<Problem> const RELEASE(problem);
+			detail::observation<typename std::remove_reference<Observer>::type> const OBSERVATION(observer);
+			forget();
+			reset(sweep_frontier, sweep_table);
+			goals.clear();
+
+			std::size_t remaining(0);
+			for(auto goal(FIRST); goal != LAST; ++goal)
+			{
+				auto &wanted(*goals.insert(*goal).first);
+				if(!wanted.wanted)
+				{
+					wanted.wanted = true;
+					++remaining;
+				}
+			}
+
+			if(remaining)
+			{
+				auto const SETTLED = [&](Node const &NODE)
+				{
+					auto *const GOAL(goals.find(NODE->state()));
+					if(GOAL && !GOAL->reached)
+					{
+						GOAL->reached = true;
+						GOAL->g = NODE->path_cost();
+						--remaining;
+					}
+					return remaining == 0;
+				};
+				detail::table_search(problem, SOURCE, SETTLED, sweep_frontier, sweep_table, SWEEP_COMPARE, observer);
+			}
+
+			for(auto goal(FIRST); goal != LAST; ++goal)
+			{
+				auto const &FOUND(*goals.find(*goal));
+				*costs++ = FOUND.reached ? FOUND.g : std::numeric_limits<PathCost>::max();
+			}
+			return costs;
+		}
+
+		// Make room for a query that reaches COUNT states, if the Table and PriorityQueue can.
+		void reserve(std::size_t const COUNT)
+		{
+			table.reserve(COUNT);
+			sweep_table.reserve(COUNT);
+		}
+
+	private:
+		typedef Table<State, detail::table_entry<typename Frontier::handle_type, PathCost>> StateTable;
+
+		// Build the search in the snapshot described by HEADER, whose goal state is at IN.
+		void rebuild(snapshot_header const &HEADER, unsigned char const *in)
+		{
+			typedef state_serializer<State> StateBytes;
+			typedef state_serializer<Action> ActionBytes;
+			typedef state_serializer<PathCost> CostBytes;
+			std::size_t const NODE_SIZE(StateBytes::size + ActionBytes::size + CostBytes::size + sizeof(std::uint64_t));
+			std::size_t const CLOSED_SIZE(StateBytes::size + CostBytes::size);
+
+			goal = StateBytes::read(in);
+			in += StateBytes::size;
+
+			std::vector<Node> nodes;
+			nodes.reserve(HEADER.nodes);
+			for(std::uint64_t i(0); i != HEADER.nodes; ++i, in += NODE_SIZE)
+			{
+				std::uint64_t parent;
+				std::memcpy(&parent, in + StateBytes::size + ActionBytes::size + CostBytes::size, sizeof parent);
+				if(parent != std::numeric_limits<std::uint64_t>::max() && !(parent < i))
+					throw std::runtime_error("not a snapshot of this search");
+				nodes.push_back(problem.create(StateBytes::read(in), parent < i ? nodes[parent] : Node(), ActionBytes::read(in + StateBytes::size), CostBytes::read(in + StateBytes::size + ActionBytes::size)));
+			}
+
+			for(std::uint64_t i(0); i != HEADER.frontier; ++i, in += sizeof(std::uint64_t))
+			{
+				std::uint64_t node;
+				std::memcpy(&node, in, sizeof node);
+				if(!(node < nodes.size()))
+					throw std::runtime_error("not a snapshot of this search");
+				auto &entry(*table.insert(nodes[node]->state()).first);
+				entry.open = true;
+				entry.handle = frontier.push(nodes[node]);
+			}
+
+			for(std::uint64_t i(0); i != HEADER.closed; ++i, in += CLOSED_SIZE)
+			{
+				auto &entry(*table.insert(StateBytes::read(in)).first);
+				entry.g = CostBytes::read(in + StateBytes::size);
+			}
+		}
+
+		// Release the nodes of a stopped search, which were kept for resume().
+		void forget()
+		{
+			if(interrupted)
+			{
+				interrupted = false;
+				problem.release();
+			}
+		}
+
+		// The search did not stop early, so its nodes can go.
+		template <typename Output>
+		PathCost finish(Node const &FOUND, Output path)
+		{
+			interrupted = false;
+			detail::release_guard<Problem> const RELEASE(problem);
+			if(!FOUND)
+				throw goal_not_found();
+
+			detail::unravel(path, FOUND);
+			return FOUND->path_cost();
+		}
+
+		template <class Queue, class Map>
+		static void reset(Queue &queue, Map &map)
+		{
+			queue.clear();
+			map.clear();
+		}
+
+		Problem const &problem;
+		Comparator<Traits> const COMPARE;
+		SimpleComparator<Traits, detail::sweep_cost> const SWEEP_COMPARE;
+		Frontier frontier;
+		StateTable table;
+		State goal;
+		bool interrupted; // The search on frontier and table was stopped by an exception.
+		SweepFrontier sweep_frontier;
+		Table<State, detail::table_entry<typename SweepFrontier::handle_type, PathCost>> sweep_table;
+		Table<State, detail::sweep_goal<PathCost>> goals;
+	};
+}
+
+#endif // SEARCH_CONTEXT_H
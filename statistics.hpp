@@ -0,0 +1,221 @@
+/*
+    statistics.hpp: Observers that the search functions report their progress to.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file statistics.hpp
+ * @brief Search observers: null_observer, which does nothing, and statistics, which measures a search.
+ *
+ * Each sequential search function takes an Observer as its last argument, defaulting to null_observer, and each
+ * parallel one takes one for each thread.  They call it as follows:
+ *
+ *   void started();                            Before the initial node is created.
+ *   void finished();                           When the search returns or throws goal_not_found.
+ *   void popped();                             A node was taken off the frontier.
+ *   void expanded(Node const &, Evaluator const &);
+ *                                              A node's successors are about to be generated.
+ *                                              Evaluator::f(Node) returns the node's f.
+ *   void pushed();                             A child was added to the frontier.
+ *   void decreased();                          A child replaced its duplicate on the frontier.
+ *   void discarded();                          A child was not as good as its duplicate.
+ *   void pruned();                             A node was forgotten to save memory.
+ *   void sizes(std::size_t frontier, std::size_t closed);
+ *                                              The sizes after an expansion.
+ *   void iteration(Cost threshold);            An iterative-deepening search started a new iteration.
+ *   auto measure(phase, F f) -> decltype(f()); Call f, which calls the policy of that phase.
+ *
+ * An observer belongs to one search, so searches running at the same time need one each.  The parallel
+ * searches take one for each thread instead, whose statistics can then be merged.  An observer may also stop
+ * a search by throwing, as budgeted in budget.hpp does.
+ */
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace jsearch
+{
+	/**
+	 * @brief The policies of a Problem that a search spends its time in.
+	 *
+	 * h is the evaluation that EvaluatingNodeCreator puts off, until a node is popped for a lazy heuristic or
+	 * until all of the children of an expansion are made for a batched one.  When nodes are evaluated as they
+	 * are created, the time spent in h is part of child.
+	 */
+	enum class phase { actions, goal_test, child, h };
+
+
+	/**
+	 * @brief Observer that ignores everything, so all of the calls to it compile away.
+	 */
+	struct null_observer
+	{
+		void started() {}
+		void finished() {}
+		void popped() {}
+		template <typename Node, typename Evaluator>
+		void expanded(Node const &, Evaluator const &) {}
+		void pushed() {}
+		void decreased() {}
+		void discarded() {}
+		void pruned() {}
+		void sizes(std::size_t, std::size_t) {}
+		template <typename Cost>
+		void iteration(Cost const &) {}
+
+		template <typename F>
+		auto measure(phase, F f) -> decltype(f()) { return f(); }
+	};
+
+
+	/**
+	 * @brief Observer that counts and times everything a search does.
+	 *
+	 * Cost is the type of f, the key of the histogram of expansions by f-layer.
+	 */
+	template <typename Cost>
+	class statistics
+	{
+	public:
+		typedef std::chrono::steady_clock clock;
+		typedef clock::duration duration;
+
+		statistics() : popped_(0), pushed_(0), decreased_(0), discarded_(0), pruned_(0), expanded_(0), peak_frontier_(0), peak_closed_(0), elapsed_(duration::zero())
+		{
+			phases_.fill(duration::zero());
+		}
+
+		void started() { start = clock::now(); }
+		void finished() { elapsed_ += clock::now() - start; }
+		void popped() { ++popped_; }
+
+		template <typename Node, typename Evaluator>
+		void expanded(Node const &NODE, Evaluator const &EVALUATOR)
+		{
+			++expanded_;
+			++f_layers_[EVALUATOR.f(NODE)];
+			if(!iterations_.empty())
+				++iterations_.back().second;
+		}
+
+		void pushed() { ++pushed_; }
+		void decreased() { ++decreased_; }
+		void discarded() { ++discarded_; }
+		void pruned() { ++pruned_; }
+
+		void sizes(std::size_t const FRONTIER, std::size_t const CLOSED)
+		{
+			if(FRONTIER > peak_frontier_)
+				peak_frontier_ = FRONTIER;
+			if(CLOSED > peak_closed_)
+				peak_closed_ = CLOSED;
+		}
+
+		void iteration(Cost const &THRESHOLD) { iterations_.emplace_back(THRESHOLD, 0); }
+
+		template <typename F>
+		auto measure(phase const PHASE, F f) -> decltype(f())
+		{
+			timer const TIMER(phases_[static_cast<std::size_t>(PHASE)]);
+			return f();
+		}
+
+		std::size_t nodes_popped() const { return popped_; }
+		std::size_t nodes_pushed() const { return pushed_; }
+		std::size_t nodes_decreased() const { return decreased_; }
+		std::size_t nodes_discarded() const { return discarded_; }
+		std::size_t nodes_pruned() const { return pruned_; }
+		std::size_t nodes_expanded() const { return expanded_; }
+		std::size_t peak_frontier() const { return peak_frontier_; }
+		std::size_t peak_closed() const { return peak_closed_; }
+
+		// Total time between started() and finished(), over every search observed.
+		duration elapsed() const { return elapsed_; }
+		duration time_in(phase const PHASE) const { return phases_[static_cast<std::size_t>(PHASE)]; }
+
+		double expansions_per_second() const
+		{
+			auto const SECONDS(std::chrono::duration<double>(elapsed_).count());
+			return SECONDS > 0 ? expanded_ / SECONDS : 0;
+		}
+
+		/**
+		 * Add the counts and phase times of OTHER, e.g. of one thread of a parallel search, to these.  Each
+		 * peak becomes the greater of the two.  elapsed() is left as it is, since the threads of one search
+		 * run at the same time.
+		 */
+		statistics &merge(statistics const &OTHER)
+		{
+			popped_ += OTHER.popped_;
+			pushed_ += OTHER.pushed_;
+			decreased_ += OTHER.decreased_;
+			discarded_ += OTHER.discarded_;
+			pruned_ += OTHER.pruned_;
+			expanded_ += OTHER.expanded_;
+			peak_frontier_ = std::max(peak_frontier_, OTHER.peak_frontier_);
+			peak_closed_ = std::max(peak_closed_, OTHER.peak_closed_);
+			for(std::size_t i(0); i != phases_.size(); ++i)
+				phases_[i] += OTHER.phases_[i];
+			for(auto const &LAYER : OTHER.f_layers_)
+				f_layers_[LAYER.first] += LAYER.second;
+			iterations_.insert(std::end(iterations_), std::begin(OTHER.iterations_), std::end(OTHER.iterations_));
+			return *this;
+		}
+
+		// Number of nodes expanded with each value of f.
+		std::map<Cost, std::size_t> const &f_layers() const { return f_layers_; }
+
+		// The threshold of each iteration of an iterative-deepening search, and the nodes expanded in it.
+		std::vector<std::pair<Cost, std::size_t>> const &iterations() const { return iterations_; }
+
+	private:
+		// Add the lifetime of a timer to a duration, even if the timed call throws.
+		class timer
+		{
+		public:
+			explicit timer(duration &TOTAL) : total(TOTAL), START(clock::now()) {}
+			~timer() { total += clock::now() - START; }
+
+		private:
+			duration &total;
+			clock::time_point const START;
+		};
+
+		std::size_t popped_;
+		std::size_t pushed_;
+		std::size_t decreased_;
+		std::size_t discarded_;
+		std::size_t pruned_;
+		std::size_t expanded_;
+		std::size_t peak_frontier_;
+		std::size_t peak_closed_;
+		duration elapsed_;
+		std::array<duration, 4> phases_;
+		std::map<Cost, std::size_t> f_layers_;
+		std::vector<std::pair<Cost, std::size_t>> iterations_;
+		clock::time_point start;
+	};
+}
+
+#endif // STATISTICS_H
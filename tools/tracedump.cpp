@@ -0,0 +1,91 @@
+/*
+    tracedump.cpp: Print a binary trace of a search as text.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Writes one line per event, with its time in nanoseconds since the search started:
+ *
+ *   <time> expanded <hash of state> f=<f> g=<g>
+ *   <time> sizes frontier=<n> closed=<n>
+ *   <time> iteration f=<threshold>
+ *   <time> <event>
+ *
+ * then the number of events that were dropped, if any, on standard error.
+ */
+
+#include "trace.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using namespace jsearch;
+
+
+int main(int argc, char **argv)
+{
+	if(argc != 2)
+	{
+		string const ARGV0(argv[0]);
+		cerr << "Invocation: " << ARGV0.substr(ARGV0.find_last_of('/') + 1) << " <trace file>\n";
+		return EXIT_FAILURE;
+	}
+
+	ifstream in(argv[1], ios::binary);
+	if(!in)
+	{
+		cerr << argv[1] << ": cannot open\n";
+		return EXIT_FAILURE;
+	}
+
+	try
+	{
+		auto const DROPPED(read_trace(in, [](trace_event const &EVENT)
+		{
+			cout << EVENT.time << " " << to_string(EVENT.kind);
+			switch(EVENT.kind)
+			{
+				case trace_kind::expanded:
+					cout << " " << EVENT.a << " f=" << EVENT.f << " g=" << EVENT.g;
+					break;
+
+				case trace_kind::sizes:
+					cout << " frontier=" << EVENT.a << " closed=" << EVENT.b;
+					break;
+
+				case trace_kind::iteration:
+					cout << " f=" << EVENT.f;
+					break;
+
+				default:
+					break;
+			}
+			cout << "\n";
+		}));
+
+		if(DROPPED)
+			cerr << DROPPED << " events were dropped\n";
+	}
+	catch(runtime_error const &EX)
+	{
+		cerr << argv[1] << ": " << EX.what() << "\n";
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,259 @@
+/*
+    trace.hpp: Binary tracing of the events of a search.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file trace.hpp
+ * @brief tracing, an Observer that records each event of a search as a fixed-size binary record.
+ *
+ * The Observer of a search is its tracing policy: the default, null_observer, compiles to nothing, and
+ * tracing costs one store into a ring buffer per event.  The records are written to a file afterwards, or
+ * by another thread while the search runs, and printed by tools/tracedump:
+ *
+ *   spsc_ring<trace_event> ring(1 << 20);
+ *   best_first_search<...>(PROBLEM, path, tracing<Traits>(ring));
+ *   std::ofstream file("search.trace", std::ios::binary);
+ *   write_trace(file, ring);
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "statistics.hpp"
+#include "utils/spsc_ring.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+namespace jsearch
+{
+	enum class trace_kind : std::uint32_t { started, finished, popped, expanded, pushed, decreased, discarded, pruned, sizes, iteration };
+
+
+	/**
+	 * @brief One event of a search.
+	 *
+	 * expanded: a is the std::hash of the state, or 0 if it has none, and f and g are those of the node.
+	 * sizes: a is the size of the frontier and b of the closed set.
+	 * iteration: f is the new threshold.
+	 */
+	struct trace_event
+	{
+		std::uint64_t time; // Nanoseconds since the search started.
+		std::uint64_t a, b;
+		double f, g;
+		trace_kind kind;
+		std::uint32_t reserved;
+	};
+
+
+	namespace detail
+	{
+		template <typename State>
+		auto trace_hash(State const &STATE, int) -> decltype(std::uint64_t(std::hash<State>()(STATE)))
+		{
+			return std::hash<State>()(STATE);
+		}
+
+		template <typename State>
+		std::uint64_t trace_hash(State const &, long) { return 0; }
+	}
+
+
+	/**
+	 * @brief Observer that pushes a trace_event for each call onto a ring, and passes every call on to another
+	 * Observer.
+	 *
+	 * The ring must outlive the search, and it drops events rather than wait when it is full, so it should
+	 * be big enough for the whole search or be drained by another thread.  Observer may be a reference type,
+	 * e.g. statistics<Cost> &, to keep its results after the search.
+	 */
+	template <typename Traits, class Observer = null_observer>
+	class tracing
+	{
+		typedef std::chrono::steady_clock clock;
+
+	public:
+		typedef spsc_ring<trace_event> ring_type;
+
+		explicit tracing(ring_type &RING) : ring(RING), observer(), T0() {}
+		tracing(ring_type &RING, Observer OBSERVER) : ring(RING), observer(std::forward<Observer>(OBSERVER)), T0() {}
+
+		void started()
+		{
+			T0 = clock::now();
+			record(trace_kind::started);
+			observer.started();
+		}
+
+		void finished() { record(trace_kind::finished); observer.finished(); }
+		void popped() { record(trace_kind::popped); observer.popped(); }
+
+		template <typename N, typename Evaluator>
+		void expanded(N const &NODE, Evaluator const &EVALUATOR)
+		{
+			trace_event event(make(trace_kind::expanded));
+			event.f = double(EVALUATOR.f(NODE));
+			describe(event, NODE, 0);
+			ring.push(event);
+			observer.expanded(NODE, EVALUATOR);
+		}
+
+		void pushed() { record(trace_kind::pushed); observer.pushed(); }
+		void decreased() { record(trace_kind::decreased); observer.decreased(); }
+		void discarded() { record(trace_kind::discarded); observer.discarded(); }
+		void pruned() { record(trace_kind::pruned); observer.pruned(); }
+
+		void sizes(std::size_t const FRONTIER, std::size_t const CLOSED)
+		{
+			trace_event event(make(trace_kind::sizes));
+			event.a = FRONTIER;
+			event.b = CLOSED;
+			ring.push(event);
+			observer.sizes(FRONTIER, CLOSED);
+		}
+
+		template <typename Cost>
+		void iteration(Cost const &THRESHOLD)
+		{
+			trace_event event(make(trace_kind::iteration));
+			event.f = double(THRESHOLD);
+			ring.push(event);
+			observer.iteration(THRESHOLD);
+		}
+
+		template <typename F>
+		auto measure(phase const PHASE, F f) -> decltype(f()) { return observer.measure(PHASE, f); }
+
+	private:
+		trace_event make(trace_kind const KIND) const
+		{
+			trace_event event;
+			std::memset(&event, 0, sizeof event);
+			event.time = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - T0).count();
+			event.kind = KIND;
+			return event;
+		}
+
+		void record(trace_kind const KIND) { ring.push(make(KIND)); }
+
+		// The state and g of NODE, if it is a Node at all.
+		template <typename N>
+		auto describe(trace_event &event, N const &NODE, int) -> decltype(typename Traits::node(NODE), void())
+		{
+			event.a = detail::trace_hash(NODE->state(), 0);
+			event.g = double(NODE->path_cost());
+		}
+
+		template <typename N>
+		void describe(trace_event &, N const &, long) {}
+
+		ring_type &ring;
+		Observer observer;
+		clock::time_point T0;
+	};
+
+
+	/**
+	 * The file format of a trace: TRACE_MAGIC, the number of events that the ring dropped as a uint64, then
+	 * the events as they are laid out in memory.  It is not portable between machines of different byte
+	 * order or alignment.
+	 */
+	char const TRACE_MAGIC[8] = {'J', 'S', 'T', 'R', 'A', 'C', 'E', '1'};
+
+
+	/**
+	 * @brief Write the header of a trace of RING to OUT.
+	 *
+	 * write_trace() writes the header and then the events in RING, once the search has finished.  To drain the ring while a search runs, call write_trace_header() once, then write_trace_events() from
+	 * the consuming thread until the search finishes.  The count of dropped events is then that of when the
+	 * header was written.
+	 */
+	inline void write_trace_header(std::ostream &out, spsc_ring<trace_event> const &RING)
+	{
+		std::uint64_t const DROPPED(RING.dropped());
+		out.write(TRACE_MAGIC, sizeof TRACE_MAGIC);
+		out.write(reinterpret_cast<char const *>(&DROPPED), sizeof DROPPED);
+	}
+
+
+	// @return The number of events written.
+	inline std::size_t write_trace_events(std::ostream &out, spsc_ring<trace_event> &ring)
+	{
+		std::size_t n(0);
+		for(trace_event event; ring.pop(event); ++n)
+			out.write(reinterpret_cast<char const *>(&event), sizeof event);
+		return n;
+	}
+
+
+	// Pop every event in RING and write it to OUT after a header.  @return The number of events written.
+	inline std::size_t write_trace(std::ostream &out, spsc_ring<trace_event> &ring)
+	{
+		write_trace_header(out, ring);
+		return write_trace_events(out, ring);
+	}
+
+
+	/**
+	 * @brief Read a trace written by write_trace, passing each event to visit(EVENT).
+	 *
+	 * @return The number of events that the ring dropped.
+	 *
+	 * @throws std::runtime_error if IN is not a trace.
+	 */
+	template <typename Visitor>
+	std::uint64_t read_trace(std::istream &in, Visitor &&visit)
+	{
+		char magic[sizeof TRACE_MAGIC];
+		std::uint64_t dropped;
+		if(!in.read(magic, sizeof magic) || std::memcmp(magic, TRACE_MAGIC, sizeof magic) != 0 || !in.read(reinterpret_cast<char *>(&dropped), sizeof dropped))
+			throw std::runtime_error("not a trace");
+
+		trace_event event;
+		while(in.read(reinterpret_cast<char *>(&event), sizeof event))
+			visit(static_cast<trace_event const &>(event));
+		return dropped;
+	}
+
+
+	inline char const *to_string(trace_kind const KIND)
+	{
+		switch(KIND)
+		{
+			case trace_kind::started: return "started";
+			case trace_kind::finished: return "finished";
+			case trace_kind::popped: return "popped";
+			case trace_kind::expanded: return "expanded";
+			case trace_kind::pushed: return "pushed";
+			case trace_kind::decreased: return "decreased";
+			case trace_kind::discarded: return "discarded";
+			case trace_kind::pruned: return "pruned";
+			case trace_kind::sizes: return "sizes";
+			case trace_kind::iteration: return "iteration";
+			default: return "unknown";
+		}
+	}
+}
+
+#endif // TRACE_H
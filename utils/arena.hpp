@@ -0,0 +1,102 @@
+#ifndef JSEARCH_ARENA_HPP
+#define JSEARCH_ARENA_HPP 1
+
+/*
+    arena.hpp: Slab allocator for objects that all die together.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * NOTE: This header was not designed to be included manually.  It will be
+ * included automatically by the problem header.
+ */
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace jsearch
+{
+	/**
+	 * Construct objects of type T in contiguous slabs of SLAB_SIZE elements.
+	 *
+	 * Objects are never destroyed individually: clear() destroys all of them at once and keeps the slabs for
+	 * the next batch, and the destructor returns the slabs to the system.  Pointers to the objects remain
+	 * valid until then, since slabs never move.
+	 */
+	template <typename T, std::size_t SLAB_SIZE = 4096>
+	class arena
+	{
+		typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+	public:
+		typedef T value_type;
+		typedef std::size_t size_type;
+
+		arena() : size_(0) {}
+		~arena() { clear(); }
+		arena(arena<T, SLAB_SIZE> const &) = delete;
+		arena<T, SLAB_SIZE> &operator=(arena<T, SLAB_SIZE> const &) = delete;
+
+		/**
+		 * Construct a T from ARGS in the next free slot.
+		 * Amortized O(1): a new slab is only allocated once per SLAB_SIZE objects.
+		 */
+		template <typename... Args>
+		T *construct(Args&&... ARGS)
+		{
+			if(size_ / SLAB_SIZE == slabs.size())
+				slabs.emplace_back(new storage[SLAB_SIZE]);
+
+			T *const RESULT(new (slot(size_)) T(std::forward<Args>(ARGS)...));
+			++size_;
+			return RESULT;
+		}
+
+		/**
+		 * Destroy every object in the arena.  The memory is kept for reuse.
+		 */
+		void clear()
+		{
+			destroy(std::is_trivially_destructible<T>());
+			size_ = 0;
+		}
+
+		size_type size() const { return size_; }
+		bool empty() const { return size_ == 0; }
+		size_type capacity() const { return slabs.size() * SLAB_SIZE; }
+
+	private:
+		void *slot(size_type const I) { return &slabs[I / SLAB_SIZE][I % SLAB_SIZE]; }
+
+		void destroy(std::true_type) {}
+
+		void destroy(std::false_type)
+		{
+			for(size_type i(0); i != size_; ++i)
+				static_cast<T *>(slot(i))->~T();
+		}
+
+		std::vector<std::unique_ptr<storage[]>> slabs;
+		size_type size_;
+	};
+} // end namespace jsearch
+
+#endif // JSEARCH_ARENA_HPP
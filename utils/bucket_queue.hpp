@@ -0,0 +1,276 @@
+#ifndef JSEARCH_BUCKET_QUEUE_HPP
+#define JSEARCH_BUCKET_QUEUE_HPP 1
+
+/*
+    bucket_queue.hpp: Monotone bucket priority queue for integer costs.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace jsearch
+{
+	/**
+	 * A priority queue of nodes with integral f, kept in one bucket per value of f.
+	 *
+	 * Comparator is the same comparator given to a Boost.Heap, but it must also provide a public f(T) that
+	 * returns an integral value, as TiebreakingComparator, SimpleComparator and CachedComparator do.  Each
+	 * bucket is a small heap ordered by Comparator itself, so nodes with equal f are ordered by its
+	 * TiePolicy.  When the TiePolicy never splits ties, a bucket is effectively a stack.
+	 *
+	 * When f never decreases below the lowest f on the queue, as with a consistent heuristic, finding the
+	 * top is amortized O(1).  Lower values of f are still handled correctly, just not as cheaply.  There is
+	 * one bucket for every value between the lowest and highest f on the queue, so this suits small integer
+	 * step costs.
+	 *
+	 * INTERFACE
+	 *
+	 * The interface is the subset of a mutable Boost.Heap used by queue_set and the search functions, so it
+	 * can be given as their PriorityQueue.  A handle is stable for as long as its element is on the queue, and
+	 * dereferences to the element.
+	 */
+	template <typename T, typename Comparator>
+	class bucket_queue
+	{
+		typedef typename std::decay<decltype(std::declval<Comparator const &>().f(std::declval<T const &>()))>::type key_type;
+		static_assert(std::is_integral<key_type>::value, "bucket_queue requires an integral f().");
+
+		struct element
+		{
+			element(T const &VALUE, key_type const &KEY) : value(VALUE), key(KEY), position(0) {}
+
+			T value;
+			key_type key;
+			std::size_t position; // Position in its bucket.
+		};
+
+		typedef std::vector<std::size_t> bucket; // Heap of indices into elements.
+
+	public:
+		typedef T value_type;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef Comparator value_compare;
+		typedef T &reference;
+		typedef T const &const_reference;
+		typedef T *pointer;
+		typedef T const *const_pointer;
+
+		class handle_type
+		{
+			friend class bucket_queue;
+
+		public:
+			handle_type() : queue(nullptr), index(0) {}
+
+			const_reference operator*() const { return queue->elements[index].value; }
+
+		private:
+			handle_type(bucket_queue const *QUEUE, std::size_t const INDEX) : queue(QUEUE), index(INDEX) {}
+
+			bucket_queue const *queue;
+			std::size_t index;
+		};
+
+		explicit bucket_queue(value_compare const &COMPARE = value_compare()) : compare(COMPARE), base(0), current(0), size_(0) {}
+
+		handle_type push(value_type const &VALUE)
+		{
+			auto const KEY(compare.f(VALUE));
+			std::size_t index;
+
+			if(free.empty())
+			{
+				index = elements.size();
+				elements.emplace_back(VALUE, KEY);
+			}
+			else
+			{
+				index = free.back();
+				free.pop_back();
+				elements[index] = element(VALUE, KEY);
+			}
+
+			insert(index);
+			++size_;
+			return handle_type(this, index);
+		}
+
+		template <typename... Args>
+		handle_type emplace(Args&&... ARGS)
+		{
+			return push(value_type(std::forward<Args>(ARGS)...));
+		}
+
+		const_reference top() const
+		{
+			assert(!empty());
+			return elements[buckets[first()].front()].value;
+		}
+
+		void pop()
+		{
+			assert(!empty());
+			auto const I(buckets[first()].front());
+			erase(I);
+			elements[I].value = value_type(); // Let go of the node now rather than when the slot is reused.
+			free.push_back(I);
+			--size_;
+		}
+
+		bool empty() const { return size_ == 0; }
+		size_type size() const { return size_; }
+		size_type max_size() const { return elements.max_size(); }
+		value_compare const &value_comp() const { return compare; }
+
+		void clear()
+		{
+			elements.clear();
+			free.clear();
+			buckets.clear();
+			current = 0;
+			size_ = 0;
+		}
+
+		void reserve(size_type const COUNT) { elements.reserve(COUNT); }
+
+		/**
+		 * Replace the element at HANDLE with VALUE, which may have any f.
+		 */
+		void update(handle_type const &HANDLE, value_type const &VALUE)
+		{
+			auto const I(HANDLE.index);
+			erase(I);
+			elements[I].value = VALUE;
+			elements[I].key = compare.f(VALUE);
+			insert(I);
+		}
+
+		void increase(handle_type const &HANDLE, value_type const &VALUE) { update(HANDLE, VALUE); }
+		void decrease(handle_type const &HANDLE, value_type const &VALUE) { update(HANDLE, VALUE); }
+
+	private:
+		// Index of the lowest non-empty bucket.
+		std::size_t first() const
+		{
+			while(buckets[current].empty())
+				++current;
+			return current;
+		}
+
+		void insert(std::size_t const I)
+		{
+			auto const KEY(elements[I].key);
+
+			if(size_ == 0)
+			{
+				// Re-base an empty queue on the new key.
+				base = KEY;
+				current = 0;
+			}
+			else if(KEY < base)
+			{
+				auto const SHIFT(static_cast<std::size_t>(base - KEY));
+				buckets.insert(std::begin(buckets), SHIFT, bucket());
+				base = KEY;
+				current = 0;
+			}
+
+			auto const B(static_cast<std::size_t>(KEY - base));
+			if(B >= buckets.size())
+				buckets.resize(B + 1);
+			if(B < current)
+				current = B;
+
+			bucket &b(buckets[B]);
+			elements[I].position = b.size();
+			b.push_back(I);
+			sift_up(b, b.size() - 1);
+		}
+
+		void erase(std::size_t const I)
+		{
+			bucket &b(buckets[static_cast<std::size_t>(elements[I].key - base)]);
+			auto const POSITION(elements[I].position);
+			auto const LAST(b.back());
+			b.pop_back();
+
+			if(LAST != I)
+			{
+				place(b, POSITION, LAST);
+				sift_up(b, POSITION);
+				sift_down(b, elements[LAST].position);
+			}
+		}
+
+		void place(bucket &b, std::size_t const POSITION, std::size_t const I)
+		{
+			b[POSITION] = I;
+			elements[I].position = POSITION;
+		}
+
+		// True if the element at position A of b belongs below the one at B.
+		bool below(bucket const &b, std::size_t const A, std::size_t const B) const
+		{
+			return compare(elements[b[A]].value, elements[b[B]].value);
+		}
+
+		void sift_up(bucket &b, std::size_t position)
+		{
+			while(position != 0)
+			{
+				auto const PARENT((position - 1) / 2);
+				if(!below(b, PARENT, position))
+					break;
+				auto const I(b[position]);
+				place(b, position, b[PARENT]);
+				place(b, PARENT, I);
+				position = PARENT;
+			}
+		}
+
+		void sift_down(bucket &b, std::size_t position)
+		{
+			for(auto child(2 * position + 1); child < b.size(); child = 2 * position + 1)
+			{
+				if(child + 1 < b.size() && below(b, child, child + 1))
+					++child;
+				if(!below(b, position, child))
+					break;
+				auto const I(b[position]);
+				place(b, position, b[child]);
+				place(b, child, I);
+				position = child;
+			}
+		}
+
+		Comparator compare;
+		std::vector<element> elements; // Indexed by handle.
+		std::vector<std::size_t> free; // Unused indices of elements.
+		std::vector<bucket> buckets; // Bucket i holds the elements with key base + i.
+		key_type base;
+		mutable std::size_t current; // No bucket below this one holds anything.
+		size_type size_;
+	};
+} // end namespace jsearch
+
+#endif // JSEARCH_BUCKET_QUEUE_HPP
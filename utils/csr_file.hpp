@@ -0,0 +1,209 @@
+#ifndef JSEARCH_CSR_FILE_HPP
+#define JSEARCH_CSR_FILE_HPP 1
+
+/*
+    csr_file.hpp: A file format for csr_graph that is written in place and used where it is mapped.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "csr_graph.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace jsearch
+{
+	/**
+	 * The file format of a csr_graph: a csr_file_header, then the offsets, the targets and the weights of the
+	 * graph, each as the array that csr_graph uses and each starting on a multiple of 64 bytes.  So a mapping
+	 * of the file is the graph, with nothing to parse or copy.  Like a snapshot, it is not portable between
+	 * machines of different byte order or word size.
+	 */
+	char const CSR_MAGIC[8] = {'J', 'S', 'C', 'S', 'R', 'G', 'R', '1'};
+
+
+	struct csr_file_header
+	{
+		char magic[8];
+		std::uint64_t edge_size, vertex_size, weight_size; // To check that the file is of the same kind of graph.
+		std::uint64_t vertices, edges;
+	};
+
+
+	// Where each array of a graph of VERTICES vertices and EDGES edges is in its file.
+	template <typename Weight, typename Vertex>
+	struct csr_file_layout
+	{
+		typedef typename csr_graph<Weight, Vertex>::edge_type edge_type;
+
+		csr_file_layout(std::uint64_t const VERTICES, std::uint64_t const EDGES) :
+			offsets(align(sizeof(csr_file_header))),
+			targets(align(offsets + (VERTICES + 1) * sizeof(edge_type))),
+			weights(align(targets + EDGES * sizeof(Vertex))),
+			size(weights + EDGES * sizeof(Weight)) {}
+
+		static std::uint64_t align(std::uint64_t const BYTES) { return (BYTES + 63) / 64 * 64; }
+
+		std::uint64_t offsets, targets, weights, size;
+	};
+
+
+	// A mapping of a whole file, which is unmapped when it is destroyed.
+	class csr_mapping
+	{
+	public:
+		csr_mapping(int const FD, std::size_t const SIZE, int const PROTECTION, int const FLAGS) : data_(mmap(nullptr, SIZE, PROTECTION, FLAGS, FD, 0)), size_(SIZE)
+		{
+			if(data_ == MAP_FAILED)
+				throw std::system_error(errno, std::generic_category(), "mmap");
+		}
+
+		~csr_mapping() { munmap(data_, size_); }
+
+		csr_mapping(csr_mapping const &) = delete;
+		csr_mapping &operator=(csr_mapping const &) = delete;
+
+		unsigned char *data() const { return static_cast<unsigned char *>(data_); }
+		std::size_t size() const { return size_; }
+
+	private:
+		void *data_;
+		std::size_t size_;
+	};
+
+
+	/**
+	 * Write a graph of VERTICES vertices and EDGES edges to PATH by calling fill(offsets, targets, weights)
+	 * with its arrays in a shared mapping of the file, to be filled as for the arrays given to csr_graph.
+	 * So the graph is never in memory as well, and the kernel writes it back as fill goes.  It is written to
+	 * PATH.tmp and then renamed, so that PATH is never a file that was only partly written.
+	 *
+	 * @throws std::system_error if the file cannot be created, sized, mapped or renamed.
+	 */
+	template <typename Weight, typename Vertex, typename Fill>
+	void write_csr_graph(std::string const &PATH, std::size_t const VERTICES, std::size_t const EDGES, Fill &&fill)
+	{
+		typedef typename csr_graph<Weight, Vertex>::edge_type edge_type;
+
+		csr_file_layout<Weight, Vertex> const LAYOUT(VERTICES, EDGES);
+		std::string const TEMPORARY(PATH + ".tmp");
+		int const FD(open(TEMPORARY.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644));
+		if(FD == -1)
+			throw std::system_error(errno, std::generic_category(), TEMPORARY);
+
+		try
+		{
+			if(ftruncate(FD, LAYOUT.size) == -1)
+				throw std::system_error(errno, std::generic_category(), "ftruncate");
+			{
+				csr_mapping const MAPPED(FD, LAYOUT.size, PROT_READ | PROT_WRITE, MAP_SHARED);
+				csr_file_header header;
+				std::memcpy(header.magic, CSR_MAGIC, sizeof header.magic);
+				header.edge_size = sizeof(edge_type);
+				header.vertex_size = sizeof(Vertex);
+				header.weight_size = sizeof(Weight);
+				header.vertices = VERTICES;
+				header.edges = EDGES;
+				std::memcpy(MAPPED.data(), &header, sizeof header);
+				fill(reinterpret_cast<edge_type *>(MAPPED.data() + LAYOUT.offsets), reinterpret_cast<Vertex *>(MAPPED.data() + LAYOUT.targets), reinterpret_cast<Weight *>(MAPPED.data() + LAYOUT.weights));
+			}
+			close(FD);
+		}
+		catch(...)
+		{
+			close(FD);
+			unlink(TEMPORARY.c_str());
+			throw;
+		}
+
+		if(std::rename(TEMPORARY.c_str(), PATH.c_str()) != 0)
+		{
+			int const ERROR(errno);
+			unlink(TEMPORARY.c_str());
+			throw std::system_error(ERROR, std::generic_category(), "rename");
+		}
+	}
+
+
+	/**
+	 * Map the graph written by write_csr_graph at PATH, and return a csr_graph that uses it where it is.  The
+	 * mapping is private, so set_weight() works, but only changes the graph in memory, not the file.
+	 *
+	 * @throws std::runtime_error if PATH is not a graph of this Weight and Vertex.
+	 * @throws std::system_error if PATH cannot be mapped.
+	 */
+	template <typename Weight, typename Vertex = std::uint32_t>
+	csr_graph<Weight, Vertex> map_csr_graph(std::string const &PATH)
+	{
+		typedef typename csr_graph<Weight, Vertex>::edge_type edge_type;
+
+		int const FD(open(PATH.c_str(), O_RDONLY));
+		if(FD == -1)
+			throw std::system_error(errno, std::generic_category(), PATH);
+
+		struct stat status;
+		if(fstat(FD, &status) == -1)
+		{
+			int const ERROR(errno);
+			close(FD);
+			throw std::system_error(ERROR, std::generic_category(), "fstat");
+		}
+		std::uint64_t const SIZE(status.st_size);
+		if(SIZE < sizeof(csr_file_header))
+		{
+			close(FD);
+			throw std::runtime_error("not a CSR graph");
+		}
+
+		std::shared_ptr<csr_mapping> file;
+		try
+		{
+			file = std::make_shared<csr_mapping>(FD, SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE);
+		}
+		catch(...)
+		{
+			close(FD);
+			throw;
+		}
+		close(FD); // The mapping keeps the file.
+
+		csr_file_header header;
+		std::memcpy(&header, file->data(), sizeof header);
+		if(std::memcmp(header.magic, CSR_MAGIC, sizeof header.magic) != 0)
+			throw std::runtime_error("not a CSR graph");
+		csr_file_layout<Weight, Vertex> const LAYOUT(header.vertices, header.edges);
+		if(header.edge_size != sizeof(edge_type) || header.vertex_size != sizeof(Vertex) || header.weight_size != sizeof(Weight) || SIZE != LAYOUT.size)
+			throw std::runtime_error("not a CSR graph of this kind");
+
+		unsigned char *const DATA(file->data());
+		return csr_graph<Weight, Vertex>(std::move(file), header.vertices, header.edges, reinterpret_cast<edge_type const *>(DATA + LAYOUT.offsets), reinterpret_cast<Vertex const *>(DATA + LAYOUT.targets), reinterpret_cast<Weight *>(DATA + LAYOUT.weights));
+	}
+} // end namespace jsearch
+
+#endif // JSEARCH_CSR_FILE_HPP
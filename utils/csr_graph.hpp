@@ -0,0 +1,181 @@
+#ifndef JSEARCH_CSR_GRAPH_HPP
+#define JSEARCH_CSR_GRAPH_HPP 1
+
+/*
+    csr_graph.hpp: Compressed sparse row graph for explicit search spaces.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+namespace jsearch
+{
+	/**
+	 * A directed graph with weighted edges in compressed sparse row form: the out-edges of vertex v are the
+	 * edges offsets[v] to offsets[v + 1] - 1, whose targets and weights are stored contiguously.
+	 *
+	 * An edge is identified by its index, so out_edges(v) is just a range of integers, and the target and
+	 * weight of an edge are one array access each.  An undirected graph stores each edge once for each
+	 * direction.
+	 *
+	 * The arrays are either its own, or kept alive by some other storage, such as the mapping of a file by
+	 * map_csr_graph, so that a graph is used where it is without being copied.  Either way it can only be
+	 * moved, since a copy of a large graph is almost always a mistake.
+	 */
+	template <typename Weight, typename Vertex = std::uint32_t>
+	class csr_graph
+	{
+	public:
+		typedef Vertex vertex_type;
+		typedef std::size_t edge_type;
+		typedef Weight weight_type;
+		typedef std::size_t size_type;
+
+		// Iterates over edge indices.
+		class edge_iterator
+		{
+		public:
+			typedef std::random_access_iterator_tag iterator_category;
+			typedef edge_type value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef edge_type const *pointer;
+			typedef edge_type reference;
+
+			edge_iterator() : edge(0) {}
+			explicit edge_iterator(edge_type const EDGE) : edge(EDGE) {}
+
+			edge_type operator*() const { return edge; }
+			edge_type operator[](std::ptrdiff_t const N) const { return edge + N; }
+
+			edge_iterator &operator++() { ++edge; return *this; }
+			edge_iterator operator++(int) { edge_iterator const TMP(*this); ++edge; return TMP; }
+			edge_iterator &operator--() { --edge; return *this; }
+			edge_iterator operator--(int) { edge_iterator const TMP(*this); --edge; return TMP; }
+			edge_iterator &operator+=(std::ptrdiff_t const N) { edge += N; return *this; }
+			edge_iterator &operator-=(std::ptrdiff_t const N) { edge -= N; return *this; }
+			edge_iterator operator+(std::ptrdiff_t const N) const { return edge_iterator(edge + N); }
+			edge_iterator operator-(std::ptrdiff_t const N) const { return edge_iterator(edge - N); }
+			friend edge_iterator operator+(std::ptrdiff_t const N, edge_iterator const &I) { return I + N; }
+			std::ptrdiff_t operator-(edge_iterator const &OTHER) const { return std::ptrdiff_t(edge) - std::ptrdiff_t(OTHER.edge); }
+
+			bool operator==(edge_iterator const &OTHER) const { return edge == OTHER.edge; }
+			bool operator!=(edge_iterator const &OTHER) const { return edge != OTHER.edge; }
+			bool operator<(edge_iterator const &OTHER) const { return edge < OTHER.edge; }
+			bool operator>(edge_iterator const &OTHER) const { return edge > OTHER.edge; }
+			bool operator<=(edge_iterator const &OTHER) const { return edge <= OTHER.edge; }
+			bool operator>=(edge_iterator const &OTHER) const { return edge >= OTHER.edge; }
+
+		private:
+			edge_type edge;
+		};
+
+		// The out-edges of a vertex, as returned by an ActionsPolicy.
+		class edge_range
+		{
+		public:
+			edge_range(edge_type const FIRST, edge_type const LAST) : first(FIRST), last(LAST) {}
+
+			edge_iterator begin() const { return edge_iterator(first); }
+			edge_iterator end() const { return edge_iterator(last); }
+			size_type size() const { return last - first; }
+			bool empty() const { return first == last; }
+
+		private:
+			edge_type first, last;
+		};
+
+		csr_graph() : offsets(1, 0) { own(); }
+
+		/**
+		 * Take ownership of the arrays of a graph: OFFSETS has one element per vertex plus one, and TARGETS
+		 * and WEIGHTS have one per edge.
+		 */
+		csr_graph(std::vector<edge_type> &&OFFSETS, std::vector<Vertex> &&TARGETS, std::vector<Weight> &&WEIGHTS) : offsets(std::move(OFFSETS)), targets(std::move(TARGETS)), weights(std::move(WEIGHTS))
+		{
+			assert(!offsets.empty() && offsets.back() == targets.size() && targets.size() == weights.size());
+			own();
+		}
+
+		/**
+		 * Use the arrays of a graph of VERTICES vertices and EDGES edges where they are, which STORAGE keeps
+		 * alive for as long as the graph, or any graph that it is moved to, needs them.
+		 */
+		csr_graph(std::shared_ptr<void> STORAGE, size_type const VERTICES, size_type const EDGES, edge_type const *OFFSETS, Vertex const *TARGETS, Weight *WEIGHTS) : storage(std::move(STORAGE)), offset_data(OFFSETS), target_data(TARGETS), weight_data(WEIGHTS), vertices_(VERTICES), edges_(EDGES)
+		{
+			assert(offset_data[vertices_] == edges_);
+		}
+
+		csr_graph(csr_graph &&other) : csr_graph() { swap(other); }
+		csr_graph &operator=(csr_graph &&other) { swap(other); return *this; }
+
+		csr_graph(csr_graph const &) = delete;
+		csr_graph &operator=(csr_graph const &) = delete;
+
+		void swap(csr_graph &other)
+		{
+			// Swapping a vector keeps its elements where they are, so the pointers stay right.
+			offsets.swap(other.offsets);
+			targets.swap(other.targets);
+			weights.swap(other.weights);
+			storage.swap(other.storage);
+			std::swap(offset_data, other.offset_data);
+			std::swap(target_data, other.target_data);
+			std::swap(weight_data, other.weight_data);
+			std::swap(vertices_, other.vertices_);
+			std::swap(edges_, other.edges_);
+		}
+
+		size_type num_vertices() const { return vertices_; }
+		size_type num_edges() const { return edges_; }
+
+		edge_range out_edges(Vertex const V) const { return edge_range(offset_data[V], offset_data[V + 1]); }
+		size_type out_degree(Vertex const V) const { return offset_data[V + 1] - offset_data[V]; }
+
+		Vertex target(edge_type const E) const { return target_data[E]; }
+		Weight const &weight(edge_type const E) const { return weight_data[E]; }
+
+		// Change the weight of one edge only: an undirected edge must be changed in both of its rows.
+		void set_weight(edge_type const E, Weight const &WEIGHT) { weight_data[E] = WEIGHT; }
+
+	private:
+		void own()
+		{
+			offset_data = offsets.data();
+			target_data = targets.data();
+			weight_data = weights.data();
+			vertices_ = offsets.size() - 1;
+			edges_ = targets.size();
+		}
+
+		std::vector<edge_type> offsets;
+		std::vector<Vertex> targets;
+		std::vector<Weight> weights;
+		std::shared_ptr<void> storage;
+		edge_type const *offset_data;
+		Vertex const *target_data;
+		Weight *weight_data;
+		size_type vertices_, edges_;
+	};
+} // end namespace jsearch
+
+#endif // JSEARCH_CSR_GRAPH_HPP
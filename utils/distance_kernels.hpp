@@ -0,0 +1,97 @@
+#ifndef JSEARCH_DISTANCE_KERNELS_HPP
+#define JSEARCH_DISTANCE_KERNELS_HPP 1
+
+/*
+    distance_kernels.hpp: Distances from one point to many, for heuristics that evaluate in batches.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+namespace jsearch
+{
+	/**
+	 * The kernels take the points as separate arrays of x and y, so that each vector load is of one
+	 * coordinate of consecutive points, which is how an h_batch (see batch_heuristic) gathers them from its
+	 * states.  With AVX2 they do four points per instruction, with NEON on AArch64 two, and otherwise one;
+	 * the points left over from the vector width are done one at a time.  Which is used is decided when
+	 * compiling, e.g. by -mavx2 or -march=native.
+	 */
+
+	// Write the Euclidean distance from (X, Y) to each of the N points (XS[i], YS[i]) to distances.
+	inline void euclidean_distances(double const *XS, double const *YS, std::size_t const N, double const X, double const Y, double *distances)
+	{
+		std::size_t i(0);
+#if defined(__AVX2__)
+		__m256d const TX(_mm256_set1_pd(X)), TY(_mm256_set1_pd(Y));
+		for(; i + 4 <= N; i += 4)
+		{
+			__m256d const DX(_mm256_sub_pd(_mm256_loadu_pd(XS + i), TX));
+			__m256d const DY(_mm256_sub_pd(_mm256_loadu_pd(YS + i), TY));
+			_mm256_storeu_pd(distances + i, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(DX, DX), _mm256_mul_pd(DY, DY))));
+		}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		float64x2_t const TX(vdupq_n_f64(X)), TY(vdupq_n_f64(Y));
+		for(; i + 2 <= N; i += 2)
+		{
+			float64x2_t const DX(vsubq_f64(vld1q_f64(XS + i), TX));
+			float64x2_t const DY(vsubq_f64(vld1q_f64(YS + i), TY));
+			vst1q_f64(distances + i, vsqrtq_f64(vaddq_f64(vmulq_f64(DX, DX), vmulq_f64(DY, DY))));
+		}
+#endif
+		for(; i != N; ++i)
+		{
+			double const DX(XS[i] - X), DY(YS[i] - Y);
+			distances[i] = std::sqrt(DX * DX + DY * DY);
+		}
+	}
+
+
+	// Write the Manhattan distance from (X, Y) to each of the N points (XS[i], YS[i]) to distances.
+	inline void manhattan_distances(double const *XS, double const *YS, std::size_t const N, double const X, double const Y, double *distances)
+	{
+		std::size_t i(0);
+#if defined(__AVX2__)
+		__m256d const TX(_mm256_set1_pd(X)), TY(_mm256_set1_pd(Y)), SIGN(_mm256_set1_pd(-0.0));
+		for(; i + 4 <= N; i += 4)
+		{
+			__m256d const DX(_mm256_andnot_pd(SIGN, _mm256_sub_pd(_mm256_loadu_pd(XS + i), TX)));
+			__m256d const DY(_mm256_andnot_pd(SIGN, _mm256_sub_pd(_mm256_loadu_pd(YS + i), TY)));
+			_mm256_storeu_pd(distances + i, _mm256_add_pd(DX, DY));
+		}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		float64x2_t const TX(vdupq_n_f64(X)), TY(vdupq_n_f64(Y));
+		for(; i + 2 <= N; i += 2)
+		{
+			float64x2_t const DX(vabdq_f64(vld1q_f64(XS + i), TX));
+			float64x2_t const DY(vabdq_f64(vld1q_f64(YS + i), TY));
+			vst1q_f64(distances + i, vaddq_f64(DX, DY));
+		}
+#endif
+		for(; i != N; ++i)
+			distances[i] = std::fabs(XS[i] - X) + std::fabs(YS[i] - Y);
+	}
+} // end namespace jsearch
+
+#endif // JSEARCH_DISTANCE_KERNELS_HPP
@@ -0,0 +1,95 @@
+#ifndef JSEARCH_MPSC_QUEUE_HPP
+#define JSEARCH_MPSC_QUEUE_HPP 1
+
+/*
+    mpsc_queue.hpp: Lock-free multiple-producer, single-consumer queue.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * NOTE: This header was not designed to be included manually.  It will be
+ * included automatically by the parallel search header.
+ */
+
+#include <atomic>
+#include <utility>
+
+
+namespace jsearch
+{
+	/**
+	 * Unbounded FIFO queue that any number of threads may push to and one thread pops from, after Dmitry
+	 * Vyukov's non-intrusive MPSC queue.  push() is wait-free: one atomic exchange.  pop() never blocks, but
+	 * may briefly miss an element whose push() has not finished.
+	 */
+	template <typename T>
+	class mpsc_queue
+	{
+		struct link
+		{
+			link() : next(nullptr), value() {}
+			explicit link(T const &VALUE) : next(nullptr), value(VALUE) {}
+
+			std::atomic<link *> next;
+			T value;
+		};
+
+	public:
+		typedef T value_type;
+
+		mpsc_queue() : head(new link), tail(head.load()) {}
+
+		~mpsc_queue()
+		{
+			T tmp;
+			while(pop(tmp))
+				;
+			delete tail;
+		}
+
+		mpsc_queue(mpsc_queue<T> const &) = delete;
+		mpsc_queue<T> &operator=(mpsc_queue<T> const &) = delete;
+
+		// Safe to call from any thread.
+		void push(T const &VALUE)
+		{
+			link *const NEW(new link(VALUE));
+			link *const PREVIOUS(head.exchange(NEW, std::memory_order_acq_rel));
+			PREVIOUS->next.store(NEW, std::memory_order_release);
+		}
+
+		// Only the consuming thread may call this.  @return false if no element was available.
+		bool pop(T &value)
+		{
+			link *const NEXT(tail->next.load(std::memory_order_acquire));
+
+			if(!NEXT)
+				return false;
+
+			value = std::move(NEXT->value);
+			NEXT->value = T();
+			delete tail;
+			tail = NEXT; // NEXT is the new stub.
+			return true;
+		}
+
+	private:
+		std::atomic<link *> head; // Producers' end.
+		link *tail; // Consumer's end, always a stub whose value has been taken.
+	};
+} // end namespace jsearch
+
+#endif // JSEARCH_MPSC_QUEUE_HPP
@@ -0,0 +1,159 @@
+#ifndef JSEARCH_MULTIQUEUE_HPP
+#define JSEARCH_MULTIQUEUE_HPP 1
+
+/*
+    multiqueue.hpp: Relaxed concurrent priority queue made of many locked sequential heaps.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * NOTE: This header was not designed to be included manually.  It will be
+ * included automatically by the parallel search header.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace jsearch
+{
+	/**
+	 * A priority queue that any number of threads may push to and pop from, after the MultiQueue of Rihani,
+	 * Sanders and Dementiev (2015).  It is a number of binary heaps, each with its own lock.  push() puts the
+	 * element on a random heap, and pop() takes the better of the tops of two random heaps.  So the element
+	 * popped is only near the top, but threads rarely wait for each other: a lock that is taken is simply
+	 * passed over for another heap.  With c·p heaps for p threads, the rank of the element popped is O(c·p)
+	 * in expectation.
+	 *
+	 * Comparator orders the elements as for Boost.Heap: COMPARE(A, B) means that B comes first, so that the
+	 * top of each heap is its greatest element.
+	 *
+	 * There is no DECREASE-KEY; instead the better element is pushed as well, and the worse one is recognized
+	 * and dropped when it is popped, e.g. by looking up the best g of its state in a striped_table.
+	 */
+	template <typename T, typename Comparator>
+	class multiqueue
+	{
+		struct heap
+		{
+			heap() {}
+
+			std::mutex lock;
+			std::vector<T> elements;
+			char padding[64]; // Keep the locks of neighbouring heaps out of each other's cache line.
+		};
+
+	public:
+		typedef T value_type;
+		typedef std::size_t size_type;
+		typedef Comparator value_compare;
+
+		explicit multiqueue(size_type const QUEUES, Comparator const &COMPARE = Comparator()) : heaps(std::max(QUEUES, size_type(2))), COMPARE(COMPARE), size_(0) {}
+
+		multiqueue(multiqueue const &) = delete;
+		multiqueue &operator=(multiqueue const &) = delete;
+
+		// Safe to call from any thread.
+		void push(T const &VALUE)
+		{
+			for(;;)
+			{
+				heap &h(heaps[random_heap()]);
+				std::unique_lock<std::mutex> const LOCK(h.lock, std::try_to_lock);
+				if(LOCK.owns_lock())
+				{
+					h.elements.push_back(VALUE);
+					std::push_heap(std::begin(h.elements), std::end(h.elements), COMPARE);
+					size_.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+		}
+
+		/**
+		 * Take the better of the tops of two random heaps.  If both are empty, every heap is tried in turn.
+		 * Safe to call from any thread.
+		 *
+		 * @return false if no element was found, which only means that the queue is empty if no other thread
+		 * holds a lock.
+		 */
+		bool pop(T &value)
+		{
+			auto const I(random_heap()), J(random_heap());
+			heap &first(heaps[I]), &second(heaps[I == J ? (J + 1) % heaps.size() : J]);
+			std::unique_lock<std::mutex> a(first.lock, std::try_to_lock), b(second.lock, std::try_to_lock);
+			heap *const A(a.owns_lock() && !first.elements.empty() ? &first : nullptr);
+			heap *const B(b.owns_lock() && !second.elements.empty() ? &second : nullptr);
+			if(A || B)
+			{
+				take(!B || (A && !COMPARE(A->elements.front(), B->elements.front())) ? *A : *B, value);
+				return true;
+			}
+			a = std::unique_lock<std::mutex>();
+			b = std::unique_lock<std::mutex>();
+
+			for(size_type i(0); i != heaps.size(); ++i)
+			{
+				heap &h(heaps[(I + i) % heaps.size()]);
+				std::lock_guard<std::mutex> const LOCK(h.lock);
+				if(!h.elements.empty())
+				{
+					take(h, value);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Only exact when no other thread is pushing or popping.
+		size_type size() const { return size_.load(std::memory_order_relaxed); }
+		bool empty() const { return size() == 0; }
+
+	private:
+		// Pop the top of H, which is locked.
+		void take(heap &h, T &value)
+		{
+			std::pop_heap(std::begin(h.elements), std::end(h.elements), COMPARE);
+			value = std::move(h.elements.back());
+			h.elements.pop_back();
+			size_.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		// A xorshift generator for each thread, since the quality hardly matters but the speed does.
+		size_type random_heap() const
+		{
+			static thread_local std::uint64_t state(std::hash<std::thread::id>()(std::this_thread::get_id()) | 1);
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return state % heaps.size();
+		}
+
+		std::vector<heap> heaps;
+		Comparator const COMPARE;
+		std::atomic<size_type> size_;
+	};
+} // end namespace jsearch
+
+#endif // JSEARCH_MULTIQUEUE_HPP
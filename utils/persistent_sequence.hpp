@@ -0,0 +1,147 @@
+#ifndef JSEARCH_PERSISTENT_SEQUENCE_HPP
+#define JSEARCH_PERSISTENT_SEQUENCE_HPP 1
+
+/*
+    persistent_sequence.hpp: Immutable sequence that shares its prefix with its parent.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+
+
+namespace jsearch
+{
+	/**
+	 * A sequence for states that are built by appending one element to the parent's state, as in
+	 * combinatorial problems like TSP.
+	 *
+	 * Each element is stored once, in a link to the links before it, so a child shares the whole of its
+	 * parent's sequence.  Copying a sequence copies one pointer, and push_back() allocates one link, so
+	 * result() is O(1) in time and space instead of O(depth).
+	 *
+	 * The hash of the sequence is kept up to date by push_back(), so hashing is O(1) and comparing two
+	 * sequences that are not equal is usually O(1) too.
+	 *
+	 * NOTE: Iteration goes from back() to the first element, since that is the order of the links.
+	 */
+	template <typename T, typename Hash = std::hash<T>>
+	class persistent_sequence
+	{
+		struct link
+		{
+			link(T const &VALUE, std::shared_ptr<link const> const &PREVIOUS, std::size_t const SIZE, std::size_t const HASH) : value(VALUE), previous(PREVIOUS), size(SIZE), hash(HASH) {}
+
+			T value;
+			std::shared_ptr<link const> previous;
+			std::size_t size;
+			std::size_t hash; // Hash of this and all previous elements.
+		};
+
+	public:
+		typedef T value_type;
+		typedef T const &reference;
+		typedef T const &const_reference;
+		typedef std::size_t size_type;
+
+		class const_iterator
+		{
+			friend class persistent_sequence;
+
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef T value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef T const *pointer;
+			typedef T const &reference;
+
+			const_iterator() : current(nullptr) {}
+
+			T const &operator*() const { return current->value; }
+			T const *operator->() const { return &current->value; }
+
+			const_iterator &operator++() { current = current->previous.get(); return *this; }
+			const_iterator operator++(int) { const_iterator const TMP(*this); ++*this; return TMP; }
+
+			bool operator==(const_iterator const &OTHER) const { return current == OTHER.current; }
+			bool operator!=(const_iterator const &OTHER) const { return current != OTHER.current; }
+
+		private:
+			explicit const_iterator(link const *CURRENT) : current(CURRENT) {}
+
+			link const *current;
+		};
+
+		typedef const_iterator iterator;
+
+		persistent_sequence() {}
+
+		void push_back(T const &VALUE)
+		{
+			last = std::make_shared<link const>(VALUE, last, size() + 1, combine(hash(), Hash()(VALUE)));
+		}
+
+		T const &back() const { assert(!empty()); return last->value; }
+
+		bool empty() const { return !last; }
+		size_type size() const { return last ? last->size : 0; }
+		std::size_t hash() const { return last ? last->hash : 0; }
+
+		const_iterator begin() const { return const_iterator(last.get()); }
+		const_iterator end() const { return const_iterator(); }
+
+		friend bool operator==(persistent_sequence const &A, persistent_sequence const &B)
+		{
+			if(A.size() != B.size() || A.hash() != B.hash())
+				return false;
+
+			// Stop as soon as the two share a link, since the rest of the sequence is then the same.
+			for(link const *a(A.last.get()), *b(B.last.get()); a != b; a = a->previous.get(), b = b->previous.get())
+			{
+				if(!(a->value == b->value))
+					return false;
+			}
+
+			return true;
+		}
+
+		friend bool operator!=(persistent_sequence const &A, persistent_sequence const &B) { return !(A == B); }
+
+	private:
+		static std::size_t combine(std::size_t const SEED, std::size_t const HASH)
+		{
+			// As boost::hash_combine.
+			return SEED ^ (HASH + 0x9e3779b9 + (SEED << 6) + (SEED >> 2));
+		}
+
+		std::shared_ptr<link const> last;
+	};
+} // end namespace jsearch
+
+
+namespace std
+{
+	template <typename T, typename Hash>
+	struct hash<jsearch::persistent_sequence<T, Hash>>
+	{
+		std::size_t operator()(jsearch::persistent_sequence<T, Hash> const &SEQUENCE) const { return SEQUENCE.hash(); }
+	};
+}
+
+#endif // JSEARCH_PERSISTENT_SEQUENCE_HPP
@@ -26,6 +26,7 @@
  * included automatically by the main search header.
  */
 
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <algorithm>
@@ -42,8 +43,8 @@ namespace jsearch
 	 *
 	 * @tparam Node pointer to node that we're indexing.
 	 *
-	 * The pointer type must provide the "element_type" type, and that
-	 * type (the actual "Node") must contain the following inner types:
+	 * The pointer type must work with std::pointer_traits, and its
+	 * element_type (the actual "Node") must contain the following inner types:
 	 *
 	 *   Node::State
 	 *
@@ -77,7 +78,8 @@ namespace jsearch
 		typedef typename PriorityQueue::const_pointer const_pointer;
 
 		typedef typename PriorityQueue::handle_type handle_type;
-        typedef typename value_type::element_type::State key_type;
+		typedef typename PriorityQueue::value_compare value_compare;
+        typedef typename std::pointer_traits<value_type>::element_type::State key_type;
 		typedef handle_type mapped_type;
 
 	private:
@@ -91,7 +93,10 @@ namespace jsearch
 		typedef typename StateHandleMap::reference		 map_reference;
 		typedef typename StateHandleMap::value_type     map_value_type;
 
-		// Use the default constructors and destructors.
+		queue_set() {}
+
+		// For a comparator with state, such as the weight of an anytime search.
+		explicit queue_set(value_compare const &COMPARE) : priority_queue(COMPARE) {}
 		
 		/**
 		 * Push @a node on to the priority queue.
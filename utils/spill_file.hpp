@@ -0,0 +1,203 @@
+#ifndef JSEARCH_SPILL_FILE_HPP
+#define JSEARCH_SPILL_FILE_HPP 1
+
+/*
+    spill_file.hpp: Anonymous temporary files that are written sequentially and read back by mmap.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * NOTE: This header was not designed to be included manually.  It will be
+ * included automatically by the external search and search context headers.
+ */
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace jsearch
+{
+	/**
+	 * A temporary file in DIRECTORY that is only ever appended to, with the buffering of stdio.  The first
+	 * MEMORY bytes are kept in memory, and the file is only created when there are more, so that small files
+	 * cost no system calls.  The file is unlinked as soon as it is created, so it is gone when it is destroyed
+	 * or the process dies.
+	 *
+	 * @throws std::system_error if the file cannot be created or written.
+	 */
+	class spill_file
+	{
+	public:
+		explicit spill_file(std::string const &DIRECTORY, std::size_t const MEMORY = 0) : directory(DIRECTORY), MEMORY(MEMORY), file(nullptr), size_(0) {}
+
+		~spill_file()
+		{
+			if(file)
+				std::fclose(file);
+		}
+
+		spill_file(spill_file const &) = delete;
+		spill_file &operator=(spill_file const &) = delete;
+
+		void write(void const *DATA, std::size_t const BYTES)
+		{
+			if(!file && size_ + BYTES <= MEMORY)
+			{
+				auto const FIRST(static_cast<unsigned char const *>(DATA));
+				memory.insert(std::end(memory), FIRST, FIRST + BYTES);
+			}
+			else
+			{
+				if(!file)
+					spill();
+				if(BYTES != 0 && std::fwrite(DATA, 1, BYTES, file) != BYTES)
+					throw std::system_error(errno, std::generic_category(), "fwrite");
+			}
+			size_ += BYTES;
+		}
+
+		// Push whatever stdio still buffers to the file, so that it can be mapped.
+		void flush()
+		{
+			if(file && std::fflush(file) != 0)
+				throw std::system_error(errno, std::generic_category(), "fflush");
+		}
+
+		std::size_t size() const { return size_; }
+
+		// Whether the contents have gone to the file.  Until then they are at in_memory().
+		bool spilled() const { return file != nullptr; }
+		unsigned char const *in_memory() const { return memory.data(); }
+		int descriptor() const { return fileno(file); }
+
+	private:
+		void spill()
+		{
+			std::string const NAME(directory + "/jsearch-XXXXXX");
+			std::vector<char> name(std::begin(NAME), std::end(NAME));
+			name.push_back('\0');
+			int const FD(mkstemp(name.data()));
+			if(FD == -1)
+				throw std::system_error(errno, std::generic_category(), "mkstemp");
+			unlink(name.data());
+			file = fdopen(FD, "w+b");
+			if(!file)
+			{
+				int const ERROR(errno);
+				close(FD);
+				throw std::system_error(ERROR, std::generic_category(), "fdopen");
+			}
+			if(!memory.empty() && std::fwrite(memory.data(), 1, memory.size(), file) != memory.size())
+				throw std::system_error(errno, std::generic_category(), "fwrite");
+			std::vector<unsigned char>().swap(memory);
+		}
+
+		std::string const directory;
+		std::size_t const MEMORY;
+		std::FILE *file;
+		std::size_t size_;
+		std::vector<unsigned char> memory;
+	};
+
+
+	/**
+	 * A read-only mapping of the whole of a spill_file as it is when the mapping is made, or of the file at
+	 * a PATH.  The kernel is told that it will be read sequentially.  If the spill_file is still in memory,
+	 * that is used instead, and the spill_file must outlive the mapping and not be written to while it is used.
+	 *
+	 * @throws std::system_error if the file cannot be opened or mapped.
+	 */
+	class mapped_file
+	{
+	public:
+		explicit mapped_file(spill_file &file) : data_(nullptr), size_(file.size()), mapped(false)
+		{
+			if(!file.spilled())
+			{
+				data_ = file.in_memory();
+				return;
+			}
+
+			file.flush();
+
+			void *const DATA(mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file.descriptor(), 0));
+			if(DATA == MAP_FAILED)
+				throw std::system_error(errno, std::generic_category(), "mmap");
+			madvise(DATA, size_, MADV_SEQUENTIAL);
+			data_ = static_cast<unsigned char const *>(DATA);
+			mapped = true;
+		}
+
+		explicit mapped_file(std::string const &PATH) : data_(nullptr), size_(0), mapped(false)
+		{
+			int const FD(open(PATH.c_str(), O_RDONLY));
+			if(FD == -1)
+				throw std::system_error(errno, std::generic_category(), PATH);
+
+			struct stat status;
+			if(fstat(FD, &status) == -1)
+			{
+				int const ERROR(errno);
+				close(FD);
+				throw std::system_error(ERROR, std::generic_category(), "fstat");
+			}
+			size_ = status.st_size;
+
+			// An empty file cannot be mapped, and has nothing to read anyway.
+			if(size_ != 0)
+			{
+				void *const DATA(mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, FD, 0));
+				int const ERROR(errno);
+				close(FD);
+				if(DATA == MAP_FAILED)
+					throw std::system_error(ERROR, std::generic_category(), "mmap");
+				madvise(DATA, size_, MADV_SEQUENTIAL);
+				data_ = static_cast<unsigned char const *>(DATA);
+				mapped = true;
+			}
+			else
+				close(FD);
+		}
+
+		~mapped_file()
+		{
+			if(mapped)
+				munmap(const_cast<unsigned char *>(data_), size_);
+		}
+
+		mapped_file(mapped_file const &) = delete;
+		mapped_file &operator=(mapped_file const &) = delete;
+
+		unsigned char const *data() const { return data_; }
+		std::size_t size() const { return size_; }
+
+	private:
+		unsigned char const *data_;
+		std::size_t size_;
+		bool mapped;
+	};
+} // end namespace jsearch
+
+#endif // JSEARCH_SPILL_FILE_HPP
@@ -0,0 +1,110 @@
+#ifndef JSEARCH_SPSC_RING_HPP
+#define JSEARCH_SPSC_RING_HPP 1
+
+/*
+    spsc_ring.hpp: Lock-free single-producer, single-consumer ring buffer.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * NOTE: This header was not designed to be included manually.  It will be
+ * included automatically by the trace header.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+
+namespace jsearch
+{
+	/**
+	 * Bounded FIFO queue with one thread pushing and one thread popping, which may be the same thread.
+	 * Both ends are wait-free: push() and pop() each do one acquire load and one release store.  When the ring
+	 * is full, push() drops the element and counts it, rather than waiting for the consumer, so the producer
+	 * is never slowed down by it.
+	 *
+	 * T must be default-constructible and copyable.  The capacity is rounded up to a power of two.
+	 */
+	template <typename T>
+	class spsc_ring
+	{
+	public:
+		typedef T value_type;
+		typedef std::size_t size_type;
+
+		explicit spsc_ring(size_type const CAPACITY) : slots(round_up(CAPACITY)), MASK(slots.size() - 1), head(0), tail(0), dropped_(0) {}
+
+		spsc_ring(spsc_ring<T> const &) = delete;
+		spsc_ring<T> &operator=(spsc_ring<T> const &) = delete;
+
+		// Only the producing thread may call this.  @return false if the ring was full, so VALUE was dropped.
+		bool push(T const &VALUE)
+		{
+			auto const HEAD(head.load(std::memory_order_relaxed));
+
+			if(HEAD - tail.load(std::memory_order_acquire) == slots.size())
+			{
+				dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				return false;
+			}
+
+			slots[HEAD & MASK] = VALUE;
+			head.store(HEAD + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Only the consuming thread may call this.  @return false if no element was available.
+		bool pop(T &value)
+		{
+			auto const TAIL(tail.load(std::memory_order_relaxed));
+
+			if(TAIL == head.load(std::memory_order_acquire))
+				return false;
+
+			value = slots[TAIL & MASK];
+			tail.store(TAIL + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Approximate unless called by one of the two threads while the other is idle.
+		size_type size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+		bool empty() const { return size() == 0; }
+		size_type capacity() const { return slots.size(); }
+
+		// The number of elements that push() dropped because the ring was full.
+		size_type dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+	private:
+		static size_type round_up(size_type const CAPACITY)
+		{
+			size_type result(1);
+			while(result < CAPACITY)
+				result *= 2;
+			return result;
+		}
+
+		std::vector<T> slots;
+		size_type const MASK;
+		// The producer's and the consumer's counters are kept apart so that they do not share a cache line.
+		std::atomic<size_type> head;
+		char padding[64];
+		std::atomic<size_type> tail;
+		std::atomic<size_type> dropped_;
+	};
+} // end namespace jsearch
+
+#endif // JSEARCH_SPSC_RING_HPP
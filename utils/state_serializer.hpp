@@ -0,0 +1,61 @@
+#ifndef JSEARCH_STATE_SERIALIZER_HPP
+#define JSEARCH_STATE_SERIALIZER_HPP 1
+
+/*
+    state_serializer.hpp: Fixed-size binary form of states and actions, for files.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * NOTE: This header was not designed to be included manually.  It will be
+ * included automatically by the external search and search context headers.
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+
+namespace jsearch
+{
+	/**
+	 * @brief How a state, or an action, is written to a file and read back, in exactly size bytes.
+	 *
+	 * external_search finds duplicates by comparing the bytes, so equal states must give equal bytes.  A
+	 * trivially copyable type is copied as it is, which is right unless it has padding or several
+	 * representations of the same value.  Any other type needs a specialisation with the same members.
+	 */
+	template <typename T, typename = void>
+	struct state_serializer;
+
+
+	template <typename T>
+	struct state_serializer<T, typename std::enable_if<std::is_trivially_copyable<T>::value>::type>
+	{
+		static std::size_t const size = sizeof(T);
+
+		static void write(T const &VALUE, unsigned char *out) { std::memcpy(out, &VALUE, sizeof VALUE); }
+
+		static T read(unsigned char const *IN)
+		{
+			T result;
+			std::memcpy(&result, IN, sizeof result);
+			return result;
+		}
+	};
+} // end namespace jsearch
+
+#endif // JSEARCH_STATE_SERIALIZER_HPP
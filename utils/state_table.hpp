@@ -0,0 +1,190 @@
+#ifndef JSEARCH_STATE_TABLE_HPP
+#define JSEARCH_STATE_TABLE_HPP 1
+
+/*
+    state_table.hpp: Open-addressing hash table of search states.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * NOTE: This header was not designed to be included manually.  It will be
+ * included automatically by the main search header.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+
+namespace jsearch
+{
+	/**
+	 * Map each State seen by a search to a Value, typically its status on the frontier or in the closed set.
+	 *
+	 * All entries live in one flat array probed linearly, so looking a state up, or inserting it if it is
+	 * missing, hashes it once and usually touches a single cache line.  Entries are never erased: a search
+	 * only ever learns about more states.  Instead, clear() forgets every entry in O(1) by starting a new
+	 * generation, and keeps the array for the next search.
+	 *
+	 * Key and Value must be default-constructible.
+	 *
+	 * NOTE: Pointers returned by insert() and find() are invalidated by the next insert().
+	 */
+	template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	class state_table
+	{
+		struct slot
+		{
+			slot() : generation(0), hash(0), key(), value() {}
+
+			unsigned generation; // The slot is used if this is the table's generation.
+			std::size_t hash;
+			Key key;
+			Value value;
+		};
+
+	public:
+		typedef Key key_type;
+		typedef Value mapped_type;
+		typedef std::size_t size_type;
+
+		state_table() : size_(0), generation(1) {}
+
+		/**
+		 * Find KEY, inserting it with a value-initialized Value if it is not there.
+		 *
+		 * @return The mapped value and whether it was just inserted.
+		 */
+		std::pair<Value *, bool> insert(Key const &KEY)
+		{
+			if((size_ + 1) * 10 > slots.size() * 7)
+				grow();
+
+			auto const HASH(mix(hash(KEY)));
+			slot &s(probe(KEY, HASH));
+			bool const INSERTED(!used(s));
+
+			if(INSERTED)
+			{
+				s.generation = generation;
+				s.hash = HASH;
+				s.key = KEY;
+				s.value = Value();
+				++size_;
+			}
+
+			return std::make_pair(&s.value, INSERTED);
+		}
+
+		/**
+		 * @return The value mapped to KEY, or nullptr if KEY is not in the table.
+		 */
+		Value *find(Key const &KEY)
+		{
+			if(slots.empty())
+				return nullptr;
+
+			slot &s(probe(KEY, mix(hash(KEY))));
+			return used(s) ? &s.value : nullptr;
+		}
+
+		Value const *find(Key const &KEY) const { return const_cast<state_table *>(this)->find(KEY); }
+
+		size_type size() const { return size_; }
+		bool empty() const { return size_ == 0; }
+		size_type capacity() const { return slots.size(); }
+
+		// Forget every entry, but keep the memory.  The stale keys and values are only overwritten.
+		void clear()
+		{
+			size_ = 0;
+			if(++generation == 0)
+			{
+				// Once every 2^32 clears, the old generations have to be forgotten the slow way.
+				for(auto &s : slots)
+					s.generation = 0;
+				generation = 1;
+			}
+		}
+
+		void reserve(size_type const COUNT)
+		{
+			while(COUNT * 10 > slots.size() * 7)
+				grow();
+		}
+
+		// Call visit(KEY, VALUE) for each entry, in no particular order.
+		template <typename Visitor>
+		void for_each(Visitor &&visit) const
+		{
+			for(auto const &S : slots)
+				if(used(S))
+					visit(S.key, S.value);
+		}
+
+	private:
+		bool used(slot const &S) const { return S.generation == generation; }
+
+		// Spread the bits of HASH, since std::hash of an integer is typically the integer itself.
+		static std::size_t mix(std::size_t HASH)
+		{
+			HASH ^= HASH >> 31;
+			HASH *= static_cast<std::size_t>(0x9e3779b97f4a7c15ull);
+			HASH ^= HASH >> 29;
+			return HASH;
+		}
+
+		// Find the slot holding KEY, or the empty slot where it belongs.  There is always an empty slot.
+		slot &probe(Key const &KEY, std::size_t const HASH)
+		{
+			auto const MASK(slots.size() - 1);
+
+			for(auto i(HASH & MASK); ; i = (i + 1) & MASK)
+			{
+				slot &s(slots[i]);
+				if(!used(s) || (s.hash == HASH && equal(s.key, KEY)))
+					return s;
+			}
+		}
+
+		void grow()
+		{
+			std::vector<slot> old(slots.empty() ? 16 : slots.size() * 2);
+			old.swap(slots);
+			auto const MASK(slots.size() - 1);
+
+			for(auto &s : old)
+			{
+				if(used(s))
+				{
+					auto i(s.hash & MASK);
+					while(used(slots[i]))
+						i = (i + 1) & MASK;
+					slots[i] = std::move(s);
+				}
+			}
+		}
+
+		std::vector<slot> slots;
+		size_type size_;
+		unsigned generation;
+		Hash hash;
+		KeyEqual equal;
+	};
+} // end namespace jsearch
+
+#endif // JSEARCH_STATE_TABLE_HPP
@@ -0,0 +1,99 @@
+#ifndef JSEARCH_STRIPED_TABLE_HPP
+#define JSEARCH_STRIPED_TABLE_HPP 1
+
+/*
+    striped_table.hpp: A state_table for many threads, split into stripes with a lock each.
+    Copyright (C) 2013  Jeremy W. Murphy <jeremy.william.murphy@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * NOTE: This header was not designed to be included manually.  It will be
+ * included automatically by the parallel search header.
+ */
+
+#include "state_table.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+
+namespace jsearch
+{
+	/**
+	 * Map each State to a Value from any number of threads.  The keys are spread by their hash over a number
+	 * of state_tables, each behind its own lock, so that threads only wait for each other when they want the
+	 * same stripe at the same time.
+	 *
+	 * Values are only reached through visit(), while the stripe is locked, since a pointer into a state_table
+	 * does not outlive the next insert.
+	 */
+	template <typename Key, typename Value, typename Hash = std::hash<Key>>
+	class striped_table
+	{
+		struct stripe
+		{
+			stripe() {}
+
+			std::mutex lock;
+			state_table<Key, Value, Hash> table;
+			char padding[64]; // Keep neighbouring locks out of each other's cache line.
+		};
+
+	public:
+		typedef Key key_type;
+		typedef Value mapped_type;
+		typedef std::size_t size_type;
+
+		explicit striped_table(size_type const STRIPES = 64) : stripes(STRIPES ? STRIPES : 1), HASH() {}
+
+		/**
+		 * Call visitor(VALUE, INSERTED) with the Value of KEY, inserting it value-initialized if it is not in
+		 * the table, while no other thread can reach it.  Safe to call from any thread.
+		 *
+		 * @return What visitor returns.
+		 */
+		template <typename Visitor>
+		auto visit(Key const &KEY, Visitor &&visitor) -> decltype(visitor(std::declval<Value &>(), true))
+		{
+			// Multiply and drop the low bits, so that the stripe does not decide the slot within it as well.
+			stripe &s(stripes[(HASH(KEY) * static_cast<std::size_t>(0x9e3779b97f4a7c15ull) >> 7) % stripes.size()]);
+			std::lock_guard<std::mutex> const LOCK(s.lock);
+			auto const INSERTED(s.table.insert(KEY));
+			return visitor(*INSERTED.first, INSERTED.second);
+		}
+
+		// Only exact when no other thread is inserting.
+		size_type size()
+		{
+			size_type result(0);
+			for(auto &s : stripes)
+			{
+				std::lock_guard<std::mutex> const LOCK(s.lock);
+				result += s.table.size();
+			}
+			return result;
+		}
+
+	private:
+		std::vector<stripe> stripes;
+		Hash const HASH;
+	};
+} // end namespace jsearch
+
+#endif // JSEARCH_STRIPED_TABLE_HPP